@@ -0,0 +1,84 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "alias_table.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#include "lib/common/error.hpp"
+
+using namespace std;
+
+AliasTable::AliasTable(const int64_t* weights, uint64_t num_entries) : m_num_entries(num_entries) {
+    if(num_entries == 0) INVALID_ARGUMENT("The table must contain at least one entry");
+    for(uint64_t i = 0; i < num_entries; i++){
+        if(weights[i] < 0) INVALID_ARGUMENT("Negative weight at position " << i << ": " << weights[i]);
+        m_total_weight += weights[i];
+    }
+    if(m_total_weight == 0) INVALID_ARGUMENT("All weights are zero");
+
+    int rc = posix_memalign((void**) &m_columns, /* alignment */ 64,  /* size */ num_entries * sizeof(Column));
+    if(rc != 0) { throw std::bad_alloc(); }
+
+    // The weight of each position, scaled by the number of entries, is distributed among the columns of capacity
+    // m_total_weight. The scaled weights can exceed 64 bits.
+    using residual_t = unsigned __int128;
+    const residual_t capacity = m_total_weight;
+    unique_ptr<residual_t[]> ptr_residuals { new residual_t[num_entries] };
+    residual_t* __restrict residuals = ptr_residuals.get();
+    unique_ptr<uint64_t[]> ptr_worklist { new uint64_t[num_entries] }; // the small positions from the start, the large from the end
+    uint64_t* __restrict worklist = ptr_worklist.get();
+    uint64_t num_small = 0, num_large = 0;
+    for(uint64_t i = 0; i < num_entries; i++){
+        residuals[i] = static_cast<residual_t>(weights[i]) * num_entries;
+        if(residuals[i] < capacity){
+            worklist[num_small++] = i;
+        } else {
+            worklist[num_entries - 1 - num_large++] = i;
+        }
+    }
+
+    // fill each small column with a share of a large position
+    while(num_small > 0 && num_large > 0){
+        uint64_t small = worklist[--num_small];
+        uint64_t large = worklist[num_entries - num_large];
+        m_columns[small].m_threshold = static_cast<uint64_t>(residuals[small]);
+        m_columns[small].m_alias = large;
+        residuals[large] -= capacity - residuals[small];
+
+        if(residuals[large] < capacity){ // the large position becomes small
+            num_large--;
+            worklist[num_small++] = large;
+        }
+    }
+
+    // as the arithmetic is exact, the positions left have a residual equal to the capacity of their column
+    assert(num_small == 0 && "All small columns should have been filled");
+    while(num_large > 0){
+        uint64_t large = worklist[num_entries - num_large--];
+        assert(residuals[large] == capacity);
+        m_columns[large].m_threshold = m_total_weight;
+        m_columns[large].m_alias = large;
+    }
+}
+
+AliasTable::~AliasTable(){
+    free(m_columns); m_columns = nullptr;
+}
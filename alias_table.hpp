@@ -0,0 +1,71 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <random>
+
+/**
+ * Sample positions in proportion to a static array of non-negative integer weights in constant time, with the alias
+ * method of Walker, built as in Vose. Each position owns a column of capacity `total_weight()': the column is split
+ * between the position itself, up to its threshold, and a single alias. A draw picks a column uniformly and then a
+ * point in the column. The columns are built with integer arithmetic, the distribution is exact.
+ *
+ * Unlike the CountingTree, the weights cannot be altered once the table is built.
+ */
+class AliasTable {
+    AliasTable(const AliasTable&) = delete;
+    AliasTable& operator=(const AliasTable&) = delete;
+
+    struct Column {
+        uint64_t m_threshold; // draws in [0, m_threshold) select the position of the column, the rest its alias
+        uint64_t m_alias; // the other position sharing the column
+    };
+
+    Column* m_columns = nullptr; // one column for each position
+    const uint64_t m_num_entries; // number of positions
+    uint64_t m_total_weight = 0; // sum of all weights, the capacity of each column
+
+public:
+    /**
+     * Build the table for the given weights
+     * @param weights the weight of each position, non negative, with at least one weight greater than 0
+     * @param num_entries the number of positions
+     */
+    AliasTable(const int64_t* weights, uint64_t num_entries);
+
+    // Destructor
+    ~AliasTable();
+
+    // Draw a position with probability weight[position] / total_weight()
+    uint64_t sample(std::mt19937_64& random) const {
+        uint64_t position = std::uniform_int_distribution<uint64_t>{ 0, m_num_entries -1 }(random);
+        uint64_t point = std::uniform_int_distribution<uint64_t>{ 0, m_total_weight -1 }(random);
+        const Column& column = m_columns[position];
+        return (point < column.m_threshold) ? position : column.m_alias;
+    }
+
+    // Number of positions
+    uint64_t size() const { return m_num_entries; }
+
+    // Sum of all weights
+    uint64_t total_weight() const { return m_total_weight; }
+
+    // Memory footprint of the table, in bytes
+    uint64_t footprint() const { return m_num_entries * sizeof(Column); }
+};
@@ -0,0 +1,502 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Throughput of the GraphalyticsReader for the same graph stored in each compressed format. The input graph, in any
+ * format supported by the reader, is loaded in memory and stored again in the scratch directory compressed with zlib,
+ * zlib-blocked, zstd and lz4, the latter two when the program is linked to the respective library. Each copy is then
+ * read back through the GraphalyticsReader: a first pass checks that the vertices and the edges are exactly the same
+ * of the input graph, the following passes are timed.
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#if defined(HAVE_ZSTD)
+#include <zstd.h>
+#endif
+#if defined(HAVE_LZ4)
+#include <lz4frame.h>
+#endif
+
+#include "lib/common/cpu_topology.hpp"
+#include "lib/common/error.hpp"
+#include "lib/common/filesystem.hpp"
+#include "lib/common/timer.hpp"
+#include "lib/cxxopts.hpp"
+
+#include "graphalytics_reader.hpp"
+
+using namespace common;
+using namespace std;
+
+// globals
+string g_path_input; // path to the input graph, in the Graphalytics format
+string g_scratch_directory; // where to store the compressed copies of the input graph
+uint64_t g_num_threads = std::max<uint64_t>(1, cpu_topology().get_threads(false, false).size()); // number of threads to parse or decompress the input graph
+uint64_t g_buffer_size = GraphalyticsReader::default_buffer_size(); // size of the chunks read ahead from the files compressed as a single stream, in bytes
+uint64_t g_block_size = (1ull << 20); // number of records in each block of the zlib-blocked format
+uint64_t g_repetitions = 3; // number of timed passes for each format
+bool g_keep_files = false; // whether to keep the compressed copies of the input graph once the program terminates
+
+// The content of the input graph, in the binary layout of the compressed formats
+struct Graph {
+    string m_name; // name of the graph in the property file
+    bool m_directed; // whether the graph is directed
+    bool m_weighted; // whether the edges carry a weight
+    vector<uint64_t> m_vertices; // one uint64_t per vertex
+    vector<uint64_t> m_edges; // source, destination and, for weighted graphs, the bits of the weight, for each edge
+
+    uint64_t num_vertices() const { return m_vertices.size(); }
+    uint64_t edge_width() const { return m_weighted ? 3 : 2; } // number of words for each edge
+    uint64_t num_edges() const { return m_edges.size() / edge_width(); }
+    uint64_t size_in_bytes() const { return (m_vertices.size() + m_edges.size()) * sizeof(uint64_t); }
+};
+
+// The outcome of reading the graph in a given format
+struct Result {
+    string m_format; // the compression method, or `input' for the input graph
+    uint64_t m_file_size; // size of the vertex and edge files, in bytes
+    uint64_t m_best_microsecs; // time of the fastest pass
+};
+
+// function prototypes
+static void parse_command_line_arguments(int argc, char* argv[]);
+static Graph load_graph(const string& path_properties); // load the whole graph in memory
+static string store_graph(const Graph& graph, const string& format); // store the graph compressed with the given method, return the path to its property file
+static void write_zlib(const string& path, const uint64_t* records, uint64_t num_words); // compress the content as a single zlib stream
+static void write_zlib_blocked(const string& path, const uint64_t* records, uint64_t num_records, uint64_t record_width); // compress the content in independent zlib blocks, with their index
+#if defined(HAVE_ZSTD)
+static void write_zstd(const string& path, const uint64_t* records, uint64_t num_words); // compress the content as a zstd frame
+#endif
+#if defined(HAVE_LZ4)
+static void write_lz4(const string& path, const uint64_t* records, uint64_t num_words); // compress the content as an lz4 frame
+#endif
+static void verify(const Graph& graph, const string& path_properties, const string& format); // check the graph read back is the same of the input
+static uint64_t read_all(const string& path_properties); // read the whole graph, return the time elapsed in microseconds
+static uint64_t file_size(const string& path); // size of the given file, in bytes
+static void print_results(const Graph& graph, const vector<Result>& results);
+
+
+int main(int argc, char* argv[]) {
+    try {
+        parse_command_line_arguments(argc, argv);
+
+        cout << "Loading the input graph from: " << g_path_input << " ... " << endl;
+        Graph graph = load_graph(g_path_input);
+        cout << "Vertices: " << graph.num_vertices() << ", edges: " << graph.num_edges() << ", weighted: " << (graph.m_weighted ? "yes" : "no") << ", "
+                "size of the records: " << graph.size_in_bytes() / 1024 / 1024 << " MB" << endl;
+
+        vector<string> formats { "input", "zlib", "zlib-blocked" };
+#if defined(HAVE_ZSTD)
+        formats.push_back("zstd");
+#endif
+#if defined(HAVE_LZ4)
+        formats.push_back("lz4");
+#endif
+
+        vector<Result> results;
+        vector<string> files_created;
+        for(const string& format : formats){
+            string path_properties = g_path_input;
+            if(format != "input"){
+                cout << "Storing the graph compressed with " << format << " ... " << endl;
+                path_properties = store_graph(graph, format);
+                GraphalyticsReader reader { path_properties, 1 };
+                files_created.insert(files_created.end(), { path_properties, reader.get_path_vertex_list(), reader.get_path_edge_list() });
+                if(format == "zlib-blocked"){
+                    files_created.insert(files_created.end(), { reader.get_path_vertex_list() + ".index", reader.get_path_edge_list() + ".index" });
+                }
+            }
+
+            verify(graph, path_properties, format);
+
+            Result result { format, 0, numeric_limits<uint64_t>::max() };
+            {
+                GraphalyticsReader reader { path_properties, 1 };
+                result.m_file_size = file_size(reader.get_path_vertex_list()) + file_size(reader.get_path_edge_list());
+            }
+            for(uint64_t i = 0; i < g_repetitions; i++){
+                result.m_best_microsecs = std::min(result.m_best_microsecs, read_all(path_properties));
+            }
+            results.push_back(result);
+        }
+
+        print_results(graph, results);
+
+        if(!g_keep_files){
+            for(const string& path : files_created){ remove(path.c_str()); }
+        }
+    } catch (common::Error& e){
+        cerr << e << endl;
+        cerr << "Type `" << argv[0] << " --help' to check how to run the program\n";
+        cerr << "Program terminated" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+static Graph load_graph(const string& path_properties){
+    GraphalyticsReader reader { path_properties, g_num_threads, g_buffer_size };
+    Graph graph;
+    graph.m_name = reader.get_property("name");
+    graph.m_directed = reader.is_directed();
+    graph.m_weighted = reader.is_weighted();
+
+    constexpr uint64_t batch_capacity = (1ull << 16);
+    unique_ptr<uint64_t[]> ptr_batch { new uint64_t[3 * batch_capacity] };
+    uint64_t* sources = ptr_batch.get();
+    uint64_t* destinations = sources + batch_capacity;
+    double* weights = reinterpret_cast<double*>(destinations + batch_capacity);
+    uint64_t batch_sz = 0;
+
+    while((batch_sz = reader.read_vertices(sources, batch_capacity)) > 0){
+        graph.m_vertices.insert(graph.m_vertices.end(), sources, sources + batch_sz);
+    }
+    while((batch_sz = reader.read_edges(sources, destinations, weights, batch_capacity)) > 0){
+        for(uint64_t i = 0; i < batch_sz; i++){
+            graph.m_edges.push_back(sources[i]);
+            graph.m_edges.push_back(destinations[i]);
+            if(graph.m_weighted){
+                uint64_t weight;
+                memcpy(&weight, weights + i, sizeof(weight));
+                graph.m_edges.push_back(weight);
+            }
+        }
+    }
+
+    return graph;
+}
+
+static string store_graph(const Graph& graph, const string& format){
+    string basename = graph.m_name + "-" + format;
+    string path_vertices = g_scratch_directory + "/" + basename + ".v";
+    string path_edges = g_scratch_directory + "/" + basename + ".e";
+    string path_properties = g_scratch_directory + "/" + basename + ".properties";
+
+    if(format == "zlib"){
+        write_zlib(path_vertices, graph.m_vertices.data(), graph.m_vertices.size());
+        write_zlib(path_edges, graph.m_edges.data(), graph.m_edges.size());
+    } else if(format == "zlib-blocked"){
+        write_zlib_blocked(path_vertices, graph.m_vertices.data(), graph.num_vertices(), 1);
+        write_zlib_blocked(path_edges, graph.m_edges.data(), graph.num_edges(), graph.edge_width());
+#if defined(HAVE_ZSTD)
+    } else if(format == "zstd"){
+        write_zstd(path_vertices, graph.m_vertices.data(), graph.m_vertices.size());
+        write_zstd(path_edges, graph.m_edges.data(), graph.m_edges.size());
+#endif
+#if defined(HAVE_LZ4)
+    } else if(format == "lz4"){
+        write_lz4(path_vertices, graph.m_vertices.data(), graph.m_vertices.size());
+        write_lz4(path_edges, graph.m_edges.data(), graph.m_edges.size());
+#endif
+    } else {
+        ERROR("Compression method not supported: " << format);
+    }
+
+    fstream handle(path_properties, ios::out | ios::trunc);
+    if(!handle.good()) ERROR("Cannot create the property file: " << path_properties);
+    string prefix = "graph." + graph.m_name + ".";
+    handle << prefix << "vertex-file = " << basename << ".v\n";
+    handle << prefix << "edge-file = " << basename << ".e\n";
+    handle << prefix << "directed = " << (graph.m_directed ? "true" : "false") << "\n";
+    handle << prefix << "compression = " << format << "\n";
+    handle << prefix << "meta.vertices = " << graph.num_vertices() << "\n";
+    handle << prefix << "meta.edges = " << graph.num_edges() << "\n";
+    if(graph.m_weighted){
+        handle << prefix << "edge-properties.names = weight\n";
+        handle << prefix << "edge-properties.types = real\n";
+    }
+    handle.close();
+    if(handle.fail()) ERROR("Cannot write the property file: " << path_properties);
+
+    return path_properties;
+}
+
+static void write_zlib(const string& path, const uint64_t* records, uint64_t num_words){
+    fstream handle(path, ios::out | ios::binary | ios::trunc);
+    if(!handle.good()) ERROR("Cannot create the file: " << path);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if(deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK) ERROR("Cannot initialise the library zlib");
+
+    constexpr uint64_t chunk_size = (1ull << 20);
+    unique_ptr<uint8_t[]> output { new uint8_t[chunk_size] };
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(records);
+    uint64_t input_sz = num_words * sizeof(uint64_t);
+    int rc = Z_OK;
+    do {
+        uint64_t chunk_in = std::min<uint64_t>(input_sz, chunk_size);
+        stream.next_in = const_cast<uint8_t*>(input);
+        stream.avail_in = chunk_in;
+        int flush = (chunk_in == input_sz) ? Z_FINISH : Z_NO_FLUSH;
+        do {
+            stream.next_out = output.get();
+            stream.avail_out = chunk_size;
+            rc = deflate(&stream, flush);
+            if(rc == Z_STREAM_ERROR){ deflateEnd(&stream); ERROR("Cannot compress the file: " << path); }
+            handle.write(reinterpret_cast<const char*>(output.get()), chunk_size - stream.avail_out);
+        } while(stream.avail_out == 0);
+        input += chunk_in;
+        input_sz -= chunk_in;
+    } while(rc != Z_STREAM_END);
+    deflateEnd(&stream);
+
+    handle.close();
+    if(handle.fail()) ERROR("Cannot write the file: " << path);
+}
+
+static void write_zlib_blocked(const string& path, const uint64_t* records, uint64_t num_records, uint64_t record_width){
+    fstream handle(path, ios::out | ios::binary | ios::trunc);
+    if(!handle.good()) ERROR("Cannot create the file: " << path);
+    fstream handle_index(path + ".index", ios::out | ios::binary | ios::trunc);
+    if(!handle_index.good()) ERROR("Cannot create the index file: " << path << ".index");
+
+    uint64_t offset = 0;
+    vector<uint8_t> output;
+    for(uint64_t start = 0; start < num_records; start += g_block_size){
+        uint64_t num_items = std::min(g_block_size, num_records - start);
+        uLong input_sz = num_items * record_width * sizeof(uint64_t);
+        uLongf output_sz = compressBound(input_sz);
+        output.resize(output_sz);
+        int rc = compress2(output.data(), &output_sz, reinterpret_cast<const Bytef*>(records + start * record_width), input_sz, Z_DEFAULT_COMPRESSION);
+        if(rc != Z_OK) ERROR("Cannot compress the block #" << start / g_block_size << " of the file: " << path << " (rc: " << rc << ")");
+        handle.write(reinterpret_cast<const char*>(output.data()), output_sz);
+
+        uint64_t entry[2] = { offset, num_items };
+        handle_index.write(reinterpret_cast<const char*>(entry), sizeof(entry));
+        offset += output_sz;
+    }
+
+    handle.close();
+    handle_index.close();
+    if(handle.fail() || handle_index.fail()) ERROR("Cannot write the file: " << path);
+}
+
+#if defined(HAVE_ZSTD)
+static void write_zstd(const string& path, const uint64_t* records, uint64_t num_words){
+    fstream handle(path, ios::out | ios::binary | ios::trunc);
+    if(!handle.good()) ERROR("Cannot create the file: " << path);
+
+    ZSTD_CCtx* context = ZSTD_createCCtx();
+    if(context == nullptr) ERROR("Cannot initialise the library zstd");
+    const uint64_t output_capacity = ZSTD_CStreamOutSize();
+    unique_ptr<uint8_t[]> output { new uint8_t[output_capacity] };
+    ZSTD_inBuffer zinput { records, num_words * sizeof(uint64_t), 0 };
+    size_t remaining = 0;
+    do {
+        ZSTD_outBuffer zoutput { output.get(), output_capacity, 0 };
+        remaining = ZSTD_compressStream2(context, &zoutput, &zinput, ZSTD_e_end);
+        if(ZSTD_isError(remaining)){ ZSTD_freeCCtx(context); ERROR("Cannot compress the file: " << path << ": " << ZSTD_getErrorName(remaining)); }
+        handle.write(reinterpret_cast<const char*>(output.get()), zoutput.pos);
+    } while(remaining > 0);
+    ZSTD_freeCCtx(context);
+
+    handle.close();
+    if(handle.fail()) ERROR("Cannot write the file: " << path);
+}
+#endif
+
+#if defined(HAVE_LZ4)
+static void write_lz4(const string& path, const uint64_t* records, uint64_t num_words){
+    fstream handle(path, ios::out | ios::binary | ios::trunc);
+    if(!handle.good()) ERROR("Cannot create the file: " << path);
+
+    LZ4F_cctx* context = nullptr;
+    LZ4F_errorCode_t rc = LZ4F_createCompressionContext(&context, LZ4F_VERSION);
+    if(LZ4F_isError(rc)) ERROR("Cannot initialise the library lz4: " << LZ4F_getErrorName(rc));
+
+    constexpr uint64_t chunk_size = (1ull << 20);
+    const uint64_t output_capacity = LZ4F_compressBound(chunk_size, /* preferences */ nullptr);
+    unique_ptr<uint8_t[]> output { new uint8_t[output_capacity] };
+    auto check = [&](size_t rc){
+        if(LZ4F_isError(rc)){ LZ4F_freeCompressionContext(context); ERROR("Cannot compress the file: " << path << ": " << LZ4F_getErrorName(rc)); }
+        handle.write(reinterpret_cast<const char*>(output.get()), rc);
+    };
+
+    check( LZ4F_compressBegin(context, output.get(), output_capacity, /* preferences */ nullptr) );
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(records);
+    uint64_t input_sz = num_words * sizeof(uint64_t);
+    for(uint64_t start = 0; start < input_sz; start += chunk_size){
+        check( LZ4F_compressUpdate(context, output.get(), output_capacity, input + start, std::min(chunk_size, input_sz - start), /* options */ nullptr) );
+    }
+    check( LZ4F_compressEnd(context, output.get(), output_capacity, /* options */ nullptr) );
+    LZ4F_freeCompressionContext(context);
+
+    handle.close();
+    if(handle.fail()) ERROR("Cannot write the file: " << path);
+}
+#endif
+
+static void verify(const Graph& graph, const string& path_properties, const string& format){
+    GraphalyticsReader reader { path_properties, g_num_threads, g_buffer_size };
+    if(reader.is_weighted() != graph.m_weighted) ERROR("[" << format << "] The graph read back is " << (reader.is_weighted() ? "" : "not ") << "weighted");
+
+    constexpr uint64_t batch_capacity = (1ull << 16);
+    unique_ptr<uint64_t[]> ptr_batch { new uint64_t[3 * batch_capacity] };
+    uint64_t* sources = ptr_batch.get();
+    uint64_t* destinations = sources + batch_capacity;
+    double* weights = reinterpret_cast<double*>(destinations + batch_capacity);
+    uint64_t batch_sz = 0;
+
+    uint64_t num_vertices = 0;
+    while((batch_sz = reader.read_vertices(sources, batch_capacity)) > 0){
+        for(uint64_t i = 0; i < batch_sz; i++){
+            if(num_vertices + i >= graph.num_vertices()) ERROR("[" << format << "] The vertex list contains more than " << graph.num_vertices() << " vertices");
+            if(sources[i] != graph.m_vertices[num_vertices + i]) ERROR("[" << format << "] Vertex #" << num_vertices + i << ": " << sources[i] << ", expected: " << graph.m_vertices[num_vertices + i]);
+        }
+        num_vertices += batch_sz;
+    }
+    if(num_vertices != graph.num_vertices()) ERROR("[" << format << "] Vertices read: " << num_vertices << ", expected: " << graph.num_vertices());
+
+    uint64_t num_edges = 0;
+    const uint64_t width = graph.edge_width();
+    while((batch_sz = reader.read_edges(sources, destinations, weights, batch_capacity)) > 0){
+        for(uint64_t i = 0; i < batch_sz; i++){
+            uint64_t edge_id = num_edges + i;
+            if(edge_id >= graph.num_edges()) ERROR("[" << format << "] The edge list contains more than " << graph.num_edges() << " edges");
+            const uint64_t* expected = graph.m_edges.data() + edge_id * width;
+            uint64_t weight = 0;
+            if(graph.m_weighted){ memcpy(&weight, weights + i, sizeof(weight)); }
+            if(sources[i] != expected[0] || destinations[i] != expected[1] || (graph.m_weighted && weight != expected[2])){
+                ERROR("[" << format << "] Edge #" << edge_id << ": " << sources[i] << " -> " << destinations[i] << ", expected: " << expected[0] << " -> " << expected[1]);
+            }
+        }
+        num_edges += batch_sz;
+    }
+    if(num_edges != graph.num_edges()) ERROR("[" << format << "] Edges read: " << num_edges << ", expected: " << graph.num_edges());
+
+    cout << "[" << format << "] The vertices and the edges read back match the input graph" << endl;
+}
+
+static uint64_t read_all(const string& path_properties){
+    constexpr uint64_t batch_capacity = (1ull << 16);
+    unique_ptr<uint64_t[]> ptr_batch { new uint64_t[3 * batch_capacity] };
+    uint64_t* sources = ptr_batch.get();
+    uint64_t* destinations = sources + batch_capacity;
+    double* weights = reinterpret_cast<double*>(destinations + batch_capacity);
+
+    Timer timer;
+    timer.start();
+    GraphalyticsReader reader { path_properties, g_num_threads, g_buffer_size };
+    while(reader.read_vertices(sources, batch_capacity) > 0){ /* nop */ }
+    while(reader.read_edges(sources, destinations, weights, batch_capacity) > 0){ /* nop */ }
+    timer.stop();
+
+    return std::max<uint64_t>(1, timer.microseconds());
+}
+
+static uint64_t file_size(const string& path){
+    fstream handle(path, ios::in | ios::binary | ios::ate);
+    if(!handle.good()) ERROR("Cannot open the file: " << path);
+    return static_cast<uint64_t>(handle.tellg());
+}
+
+static void print_results(const Graph& graph, const vector<Result>& results){
+    cout << "\nBest of " << g_repetitions << " passes, reader threads: " << g_num_threads << ", read ahead buffer: " << g_buffer_size / 1024 << " KB\n";
+    cout << left << setw(14) << "format" << right << setw(14) << "files (MB)" << setw(12) << "time (ms)" << setw(16) << "records MB/s" << setw(16) << "edges/s" << "\n";
+    for(const Result& result : results){
+        double seconds = static_cast<double>(result.m_best_microsecs) / 1000000;
+        cout << left << setw(14) << result.m_format << right << fixed << setprecision(1)
+             << setw(14) << static_cast<double>(result.m_file_size) / 1024 / 1024
+             << setw(12) << static_cast<double>(result.m_best_microsecs) / 1000
+             << setw(16) << static_cast<double>(graph.size_in_bytes()) / 1024 / 1024 / seconds
+             << setw(16) << setprecision(0) << static_cast<double>(graph.num_edges()) / seconds << "\n";
+    }
+    cout << endl;
+}
+
+static void parse_command_line_arguments(int argc, char* argv[]){
+    using namespace cxxopts;
+
+    Options options(argv[0], "Throughput of the GraphalyticsReader for the same graph stored in each compressed format");
+    options.custom_help(" [options] <input> <scratch_directory>");
+    options.add_options()
+        ("block-size", "Number of records in each block of the zlib-blocked format", value<uint64_t>()->default_value(to_string(g_block_size)))
+        ("buffer-size", "Size of the chunks read ahead from the files compressed as a single stream, in bytes", value<uint64_t>()->default_value(to_string(g_buffer_size)))
+        ("h, help", "Show this help menu")
+        ("keep", "Keep the compressed copies of the input graph in the scratch directory")
+        ("r, repetitions", "Number of timed passes for each format, the best one is reported", value<uint64_t>()->default_value(to_string(g_repetitions)))
+        ("t, threads", "Number of threads to parse the plain text input or to decompress the zlib-blocked files", value<uint64_t>()->default_value(to_string(g_num_threads)))
+    ;
+
+    auto parsed_args = options.parse(argc, argv);
+
+    if( argc == 1 || parsed_args.count("help") > 0 ){
+        cout << options.help() << endl;
+        exit(EXIT_SUCCESS);
+    }
+
+    if( argc != 3 ) {
+        INVALID_ARGUMENT("Invalid number of arguments: " << argc << ". Expected format: " << argv[0] << " [options] <input> <scratch_directory>");
+    }
+    if(!common::filesystem::file_exists(argv[1])){
+        INVALID_ARGUMENT("The given input graph does not exist: `" << argv[1] << "'");
+    }
+    if(!common::filesystem::file_exists(argv[2])){
+        INVALID_ARGUMENT("The given scratch directory does not exist: `" << argv[2] << "'");
+    }
+    g_path_input = argv[1];
+    g_scratch_directory = argv[2];
+
+    if(parsed_args.count("block-size") > 0){
+        uint64_t value = parsed_args["block-size"].as<uint64_t>();
+        if(value < 1){
+            INVALID_ARGUMENT("The number of records in each block must be a value equal or greater than 1: " << value);
+        }
+        g_block_size = value;
+    }
+
+    if(parsed_args.count("buffer-size") > 0){
+        uint64_t value = parsed_args["buffer-size"].as<uint64_t>();
+        if(value < 4096){
+            INVALID_ARGUMENT("The size of the read ahead buffers must be a value equal or greater than 4096 bytes: " << value);
+        }
+        g_buffer_size = value;
+    }
+
+    if(parsed_args.count("keep") > 0){
+        g_keep_files = true;
+    }
+
+    if(parsed_args.count("repetitions") > 0){
+        uint64_t value = parsed_args["repetitions"].as<uint64_t>();
+        if(value < 1){
+            INVALID_ARGUMENT("The number of repetitions must be a value equal or greater than 1: " << value);
+        }
+        g_repetitions = value;
+    }
+
+    if(parsed_args.count("threads") > 0){
+        uint64_t value = parsed_args["threads"].as<uint64_t>();
+        if(value < 1){
+            INVALID_ARGUMENT("The number of threads must be a value equal or greater than 1: " << value);
+        }
+        g_num_threads = value;
+    }
+}
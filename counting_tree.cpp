@@ -25,13 +25,22 @@
 #include <iostream>
 
 #include "lib/common/error.hpp"
+#include "parallel.hpp"
+
+// The height of the smallest tree with nodes of the given size that can index `num_entries' > 0 entries
+static int32_t compute_height(uint64_t num_entries, uint64_t node_size){
+    assert(num_entries > 0);
+    int32_t height = 1;
+    for(uint64_t capacity = node_size; capacity < num_entries; capacity *= node_size){ height++; }
+    return height;
+}
 
 CountingTree::CountingTree(uint64_t num_entries, uint64_t index_node_size) : m_num_entries(num_entries), m_node_size(index_node_size) {
     if(index_node_size < 2) INVALID_ARGUMENT("Invalid block size: " << index_node_size);
     ::memset(m_subtree, 0, sizeof(m_subtree));
 
     if(m_num_entries > 0) {
-        int height = ceil(log2(m_num_entries) / log2(m_node_size));
+        int height = compute_height(m_num_entries, m_node_size);
         if (height > m_max_height) { INVALID_ARGUMENT("Invalid number of keys/segments: too big"); }
 
         // we have B^h for the leaves (nodes at height =1), B^{H-1} for height =2, B^{H-2} for height =3, ...
@@ -48,13 +57,14 @@ CountingTree::CountingTree(uint64_t num_entries, uint64_t index_node_size) : m_n
 
         // set the height of all the rightmost subtrees in the index
         while (height > 0) {
-            uint64_t subtree_sz = pow(m_node_size, height - 1);
+            uint64_t subtree_sz = subtree_reg_num_elts(height - 1);
             uint64_t rightmost_subtree_sz = num_entries % subtree_sz;
-            m_subtree[height - 1].m_rightmost_root_sz = (num_entries / subtree_sz) + (rightmost_subtree_sz != 0);
-            assert(m_subtree[height - 1].m_rightmost_root_sz > 0);
-            int rightmost_subtree_height = 0;
-            if (rightmost_subtree_sz > 0) {
-                rightmost_subtree_height = ceil(log2(rightmost_subtree_sz) / log2(m_node_size));
+            if(rightmost_subtree_sz == 0){ rightmost_subtree_sz = subtree_sz; } // the rightmost subtree is full
+            m_subtree[height - 1].m_rightmost_root_sz = (num_entries - rightmost_subtree_sz) / subtree_sz + 1;
+            assert(m_subtree[height - 1].m_rightmost_root_sz <= m_node_size);
+            int rightmost_subtree_height = 0; // the children are leaves
+            if (height > 1) {
+                rightmost_subtree_height = compute_height(rightmost_subtree_sz, m_node_size);
             }
             m_subtree[height - 1].m_rightmost_height = rightmost_subtree_height;
 
@@ -138,6 +148,55 @@ void CountingTree::unset(uint64_t position, value_t* out_old_value){
     set(position, 0, out_old_value);
 }
 
+CountingTree::value_t CountingTree::bulk_load_rec(value_t* __restrict index, const value_t* __restrict values, int32_t height, bool is_rightmost){
+    assert(height > 0 && "This is going to lead to an infinite recursion");
+    uint64_t root_sz = is_rightmost ? m_subtree[height -1].m_rightmost_root_sz : m_node_size;
+    value_t sum = 0;
+
+    if(height == 1){ // base case, the leaves
+        for(uint64_t i = 0; i < root_sz; i++){
+            if(values[i] < 0) INVALID_ARGUMENT("The given value is negative: " << values[i]);
+            index[i] = values[i];
+            sum += values[i];
+        }
+    } else {
+        uint64_t subtree_sz = subtree_reg_num_slots(height -1);
+        uint64_t subtree_num_elts = subtree_reg_num_elts(height -1);
+        for(uint64_t i = 0; i < root_sz; i++){
+            bool is_subtree_rightmost = is_rightmost && (i == root_sz -1);
+            int32_t subtree_height = is_subtree_rightmost ? m_subtree[height -1].m_rightmost_height : height -1;
+            index[i] = bulk_load_rec(index + m_node_size + i * subtree_sz, values + i * subtree_num_elts, subtree_height, is_subtree_rightmost);
+            sum += index[i];
+        }
+    }
+
+    return sum;
+}
+
+void CountingTree::bulk_load(const value_t* values, uint64_t num_threads){
+    if(m_height == 0) return; // empty tree
+    assert(values != nullptr);
+
+    if(m_height == 1){
+        m_total_count = bulk_load_rec(m_index, values, m_height, true);
+    } else {
+        // each thread loads a range of subtrees of the root, then the root is updated sequentially
+        uint64_t root_sz = m_subtree[m_height -1].m_rightmost_root_sz;
+        uint64_t subtree_sz = subtree_reg_num_slots(m_height -1);
+        uint64_t subtree_num_elts = subtree_reg_num_elts(m_height -1);
+        parallel_for(num_threads, root_sz, [&](uint64_t start, uint64_t end){
+            for(uint64_t i = start; i < end; i++){
+                bool is_subtree_rightmost = (i == root_sz -1);
+                int32_t subtree_height = is_subtree_rightmost ? m_subtree[m_height -1].m_rightmost_height : m_height -1;
+                m_index[i] = bulk_load_rec(m_index + m_node_size + i * subtree_sz, values + i * subtree_num_elts, subtree_height, is_subtree_rightmost);
+            }
+        });
+
+        m_total_count = 0;
+        for(uint64_t i = 0; i < root_sz; i++){ m_total_count += m_index[i]; }
+    }
+}
+
 uint64_t CountingTree::search(value_t value) const {
     if(value >= m_total_count) INVALID_ARGUMENT("The given value is greater than the total in the counting tree. Total count: " << m_total_count << " <= searched value: " << value);
 
@@ -175,6 +234,69 @@ uint64_t CountingTree::search(value_t value) const {
     return offset;
 }
 
+uint64_t CountingTree::search_excluding(value_t value, uint64_t position) const {
+    const value_t excluded_value = get(position);
+    if(value >= m_total_count - excluded_value) INVALID_ARGUMENT("The given value is greater than the total in the counting tree, without the position " << position << ". Total count: " << m_total_count - excluded_value << " <= searched value: " << value);
+
+    // visit the index
+    value_t* __restrict base = m_index;
+    int64_t offset = 0;
+    int height = m_height;
+    bool is_rightmost = true; // this is the rightmost subtree
+    bool is_excluded_inside = true; // whether the excluded position belongs to the current subtree
+
+    while(height > 0){
+        uint64_t subtree_sz = height >=2 ? subtree_reg_num_slots(height - 1) : 1;
+        uint64_t subtree_num_elts = subtree_reg_num_elts(height -1);
+        uint64_t node_sz = (is_rightmost) ? m_subtree[height -1].m_rightmost_root_sz : m_node_size;
+        assert(node_sz > 0);
+        uint64_t excluded_id = is_excluded_inside ? (position - offset) / subtree_num_elts : node_sz;
+        uint64_t subtree_id = 0;
+        uint64_t cumulative_sum = 0;
+
+        value_t count = base[0] - (excluded_id == 0 ? excluded_value : 0);
+        while(value >= cumulative_sum + count){
+            cumulative_sum += count;
+            subtree_id++;
+            assert(subtree_id < node_sz && "It doesn't comply with the invariant on the total count");
+            count = base[subtree_id] - (excluded_id == subtree_id ? excluded_value : 0);
+        }
+
+        is_rightmost = is_rightmost && (subtree_id == node_sz -1);
+        is_excluded_inside = (subtree_id == excluded_id);
+
+        // next iteration
+        base += /* the root of the subtree */  m_node_size + subtree_id * subtree_sz;
+        value -= cumulative_sum;
+        offset += subtree_id * subtree_num_elts;
+        height = is_rightmost ? m_subtree[height -1].m_rightmost_height : height -1;
+    }
+
+    assert(static_cast<uint64_t>(offset) != position && "The excluded position has been selected");
+    return offset;
+}
+
+CountingTree::value_t CountingTree::get(uint64_t position) const {
+    if(position >= size()) INVALID_ARGUMENT("Invalid position: " << position << ". The total size of the index is: " << size());
+
+    value_t* __restrict base = m_index;
+    int height = m_height;
+    bool is_rightmost = true; // this is the rightmost subtree
+
+    while(height > 1){
+        uint64_t subtree_num_elts = subtree_reg_num_elts(height -1);
+        uint64_t subtree_id = position / subtree_num_elts;
+        uint64_t node_sz = (is_rightmost) ? m_subtree[height -1].m_rightmost_root_sz : m_node_size;
+        is_rightmost = is_rightmost && (subtree_id == node_sz -1);
+
+        base += /* the root of the subtree */ m_node_size + subtree_id * subtree_reg_num_slots(height -1);
+        position -= subtree_id * subtree_num_elts;
+        height = is_rightmost ? m_subtree[height -1].m_rightmost_height : height -1;
+    }
+
+    return base[position];
+}
+
 uint64_t CountingTree::subtree_reg_num_elts(int32_t height) const {
     assert(height >= 0 && height <= m_height);
     if(height == 0) return 1; // base case, leaf
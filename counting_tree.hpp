@@ -66,6 +66,9 @@ private:
     template<UpdateType type>
     void update(uint64_t position, value_t value, value_t* out_old_value);
 
+    // Load the entries of the given subtree from the array `values', returning their sum
+    value_t bulk_load_rec(value_t* __restrict index, const value_t* __restrict values, int32_t height, bool is_rightmost);
+
 public:
     // Create a CountingTree with a given fixed size
     CountingTree(uint64_t num_entries, uint64_t index_node_size = 64);
@@ -79,9 +82,26 @@ public:
     // Reset to zero the score for the value at the given position
     void unset(uint64_t position, value_t* out_old_value = nullptr);
 
+    /**
+     * Replace the scores of all entries with the content of the array `values', of size() elements. The leaves are
+     * filled and the sums of the inner nodes computed bottom-up in a single pass, with the subtrees of the root split
+     * among up to `num_threads' threads. The result is the same of invoking #set for each position.
+     */
+    void bulk_load(const value_t* values, uint64_t num_threads = 1);
+
     // Return the first position such as the cumulative sum of all positions before is greater than the given value
     uint64_t search(value_t value) const;
 
+    /**
+     * As #search, as if the score at the given position was zero. The score of the excluded position is subtracted
+     * from the nodes on its path while descending, without altering the tree. The given value must be less than
+     * total_count() - get(position).
+     */
+    uint64_t search_excluding(value_t value, uint64_t position) const;
+
+    // Return the score for the value at the given position
+    value_t get(uint64_t position) const;
+
     // Return the size of the tree (number of keys indexed)
     uint64_t size() const;
 
@@ -0,0 +1,82 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "degree_buckets.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lib/common/error.hpp"
+
+using namespace std;
+
+DegreeBuckets::DegreeBuckets(const int64_t* weights, uint64_t num_entries) {
+    if(num_entries > static_cast<uint64_t>(numeric_limits<uint32_t>::max()) +1) INVALID_ARGUMENT("Too many entries: " << num_entries);
+
+    // the distinct weights and the number of positions with each weight
+    unordered_map<int64_t, uint64_t> weight2bucket; // weight -> number of positions, then bucket id
+    for(uint64_t i = 0; i < num_entries; i++){
+        if(weights[i] < 0) INVALID_ARGUMENT("Negative weight at position " << i << ": " << weights[i]);
+        if(weights[i] > 0){ weight2bucket[weights[i]]++; }
+    }
+    if(weight2bucket.empty()) INVALID_ARGUMENT("All weights are zero");
+
+    // the buckets in order of weight, so that their layout does not depend on the implementation of the hash map
+    vector<pair<int64_t, uint64_t>> buckets { weight2bucket.begin(), weight2bucket.end() };
+    sort(buckets.begin(), buckets.end());
+    m_num_buckets = buckets.size();
+
+    m_bucket_start.reset( new uint64_t[m_num_buckets +1] );
+    unique_ptr<int64_t[]> ptr_bucket_weights { new int64_t[m_num_buckets] };
+    uint64_t offset = 0;
+    for(uint64_t i = 0; i < m_num_buckets; i++){
+        int64_t weight = buckets[i].first;
+        uint64_t count = buckets[i].second;
+        m_bucket_start[i] = offset;
+        ptr_bucket_weights[i] = weight * static_cast<int64_t>(count);
+        weight2bucket[weight] = i;
+        offset += count;
+    }
+    m_bucket_start[m_num_buckets] = offset;
+    m_num_positions = offset;
+
+    // group the positions by bucket, in increasing order inside each bucket
+    m_positions.reset( new uint32_t[m_num_positions] );
+    unique_ptr<uint64_t[]> ptr_fill { new uint64_t[m_num_buckets] };
+    uint64_t* __restrict fill = ptr_fill.get();
+    for(uint64_t i = 0; i < m_num_buckets; i++){ fill[i] = m_bucket_start[i]; }
+    for(uint64_t i = 0; i < num_entries; i++){
+        if(weights[i] > 0){
+            uint64_t bucket = weight2bucket[weights[i]];
+            m_positions[fill[bucket]++] = i;
+        }
+    }
+
+    m_buckets.reset( new AliasTable(ptr_bucket_weights.get(), m_num_buckets) );
+}
+
+DegreeBuckets::~DegreeBuckets(){
+
+}
+
+uint64_t DegreeBuckets::footprint() const {
+    return m_buckets->footprint() + (m_num_buckets +1) * sizeof(uint64_t) + m_num_positions * sizeof(uint32_t);
+}
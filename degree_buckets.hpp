@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <memory>
+#include <random>
+
+#include "alias_table.hpp"
+
+/**
+ * Sample positions in proportion to a static array of non-negative integer weights, grouping the positions with the
+ * same weight in a bucket. A draw first picks a bucket through an AliasTable, weighted by the weight of its positions
+ * times their number, and then a position of the bucket uniformly. In power-law graphs, the vertex degrees have only
+ * a few thousand distinct values, the table of the buckets fits in the L2 cache and the only array proportional to the
+ * number of positions is the list of the positions grouped by bucket, 4 bytes each. The positions with weight 0 are
+ * never drawn and they are not stored.
+ *
+ * The weights cannot be altered once the buckets are built.
+ */
+class DegreeBuckets {
+    DegreeBuckets(const DegreeBuckets&) = delete;
+    DegreeBuckets& operator=(const DegreeBuckets&) = delete;
+
+    std::unique_ptr<AliasTable> m_buckets; // to draw a bucket, in proportion to its total weight
+    std::unique_ptr<uint64_t[]> m_bucket_start; // the offset in `m_positions' of each bucket, plus the end of the last bucket
+    std::unique_ptr<uint32_t[]> m_positions; // the positions with weight > 0, grouped by bucket
+    uint64_t m_num_buckets = 0; // number of distinct weights > 0
+    uint64_t m_num_positions = 0; // number of positions with weight > 0
+
+public:
+    /**
+     * Build the buckets for the given weights
+     * @param weights the weight of each position, non negative, with at least one weight greater than 0
+     * @param num_entries the number of positions, at most 2^32
+     */
+    DegreeBuckets(const int64_t* weights, uint64_t num_entries);
+
+    // Destructor
+    ~DegreeBuckets();
+
+    // Draw a position with probability weight[position] / total_weight()
+    uint64_t sample(std::mt19937_64& random) const {
+        uint64_t bucket = m_buckets->sample(random);
+        uint64_t offset = std::uniform_int_distribution<uint64_t>{ m_bucket_start[bucket], m_bucket_start[bucket +1] -1 }(random);
+        return m_positions[offset];
+    }
+
+    // Number of distinct weights greater than 0
+    uint64_t num_buckets() const { return m_num_buckets; }
+
+    // Sum of all weights
+    uint64_t total_weight() const { return m_buckets->total_weight(); }
+
+    // Memory footprint of the buckets, in bytes
+    uint64_t footprint() const;
+};
@@ -22,6 +22,8 @@
 #include <ostream>
 #include <utility>
 
+#include "hash.hpp"
+
 struct Edge {
     uint32_t m_source;
     uint32_t m_destination;
@@ -30,6 +32,7 @@ struct Edge {
     Edge(uint32_t source, uint32_t destination) : m_source(source), m_destination(destination) { };
     uint32_t source() const { return m_source; }
     uint32_t destination() const { return m_destination; }
+    Edge edge() const { return *this; }
 
     // Relative order of the edges
     bool operator==(const Edge&) const noexcept;
@@ -54,34 +57,31 @@ struct WeightedEdge : public Edge {
     Edge edge() const;
 };
 
+/**
+ * Weight policies, to specialise the generator on whether the input graph is weighted. The policy determines the
+ * layout of the final edges: unweighted graphs only store the endpoints, 8 bytes rather than 16 bytes per edge.
+ */
+struct EdgeWeighted {
+    using edge_t = WeightedEdge;
+    static WeightedEdge make_edge(uint32_t source, uint32_t destination, double weight) { return WeightedEdge{ source, destination, weight }; }
+    static double weight(const WeightedEdge& edge) { return edge.weight(); }
+};
+
+struct EdgeUnweighted {
+    using edge_t = Edge;
+    static Edge make_edge(uint32_t source, uint32_t destination, double /* weight */) { return Edge{ source, destination }; }
+    static double weight(const Edge& /* edge */) { return 0.0; }
+};
+
 std::ostream& operator<<(std::ostream& out, const Edge& e);
 std::ostream& operator<<(std::ostream& out, const WeightedEdge& e);
 
 namespace std {
 template<>
 struct hash<Edge> { // hash function for graph::Edge
-private:
-    // Adapted from the General Purpose Hash Function Algorithms Library
-    // Author: Arash Partow - 2002
-    // URL: http://www.partow.net
-    // URL: http://www.partow.net/programming/hashfunctions/index.html
-    // MIT License
-    unsigned int APHash(uint64_t value) const {
-        unsigned int hash = 0xAAAAAAAA;
-        unsigned int i = 0;
-        char* str = (char*) &value;
-
-        for (i = 0; i < sizeof(value); ++str, ++i) {
-            hash ^= ((i & 1) == 0) ? ((hash << 7) ^ (*str) * (hash >> 3)) :
-                    (~((hash << 11) + ((*str) ^ (hash >> 5))));
-        }
-
-        return hash;
-    }
-
-public:
     size_t operator()(const Edge& e) const {
-        return APHash((static_cast<uint64_t>(e.source()) << 32) + (e.destination() & 0xFFFFFFFF));
+        // the endpoints packed in a single word
+        return mix64((static_cast<uint64_t>(e.source()) << 32) | e.destination());
     }
 };
 } // namespace std
@@ -0,0 +1,111 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "edge_map.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+#include "lib/common/error.hpp"
+
+EdgeMap::EdgeMap(uint64_t max_size) : m_max_size(max_size) {
+    uint64_t capacity = EdgeMap::capacity(max_size);
+    m_capacity_mask = capacity -1;
+
+    int rc = posix_memalign((void**) &m_slots, /* alignment */ 64,  /* size */ capacity * sizeof(Slot));
+    if(rc != 0) { throw std::bad_alloc(); }
+    for(uint64_t i = 0; i < capacity; i++){ m_slots[i].m_key = EMPTY; }
+}
+
+EdgeMap::~EdgeMap(){
+    free(m_slots); m_slots = nullptr;
+}
+
+uint64_t EdgeMap::capacity(uint64_t max_size){
+    uint64_t capacity = 16;
+    while(capacity - capacity / 4 < max_size +1){ capacity *= 2; } // always leave an empty slot to end the probes
+    return capacity;
+}
+
+uint64_t EdgeMap::key(Edge edge) {
+    return (static_cast<uint64_t>(edge.source()) << 32) | edge.destination();
+}
+
+EdgeMap::Slot* EdgeMap::probe(uint64_t key) const {
+    assert(key != EMPTY && "The self loop [2^32-1, 2^32-1] cannot be stored");
+    uint64_t position = home(key);
+    while(m_slots[position].m_key != key && m_slots[position].m_key != EMPTY){
+        position = (position +1) & m_capacity_mask;
+    }
+    return m_slots + position;
+}
+
+void EdgeMap::insert(Edge edge, uint64_t value){
+    uint64_t key = EdgeMap::key(edge);
+    Slot* slot = probe(key);
+    if(slot->m_key == EMPTY){
+        if(m_size >= m_max_size) ERROR("The map is full, max size: " << m_max_size);
+        slot->m_key = key;
+        m_size++;
+    }
+    slot->m_value = value;
+}
+
+bool EdgeMap::find(Edge edge, uint64_t* out_value) const {
+    Slot* slot = probe(key(edge));
+    if(slot->m_key == EMPTY) return false;
+    *out_value = slot->m_value;
+    return true;
+}
+
+bool EdgeMap::contains(Edge edge) const {
+    return probe(key(edge))->m_key != EMPTY;
+}
+
+bool EdgeMap::remove(Edge edge){
+    uint64_t hole = probe(key(edge)) - m_slots;
+    if(m_slots[hole].m_key == EMPTY) return false;
+
+    // shift back the entries of the cluster that would not be reachable anymore from their home slot
+    uint64_t position = hole;
+    while(true){
+        position = (position +1) & m_capacity_mask;
+        uint64_t key = m_slots[position].m_key;
+        if(key == EMPTY) break;
+
+        // the entry stays where it is if its home slot lies, cyclically, in (hole, position]
+        uint64_t key_home = home(key);
+        bool reachable = (hole <= position) ? (hole < key_home && key_home <= position) : (hole < key_home || key_home <= position);
+        if(!reachable){
+            m_slots[hole] = m_slots[position];
+            hole = position;
+        }
+    }
+
+    m_slots[hole].m_key = EMPTY;
+    m_size--;
+    return true;
+}
+
+double EdgeMap::load_factor() const {
+    return static_cast<double>(m_size) / (m_capacity_mask +1);
+}
+
+uint64_t EdgeMap::footprint() const {
+    return (m_capacity_mask +1) * sizeof(Slot);
+}
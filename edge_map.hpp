@@ -0,0 +1,91 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+
+#include "edge.hpp"
+#include "hash.hpp"
+
+/**
+ * Hash map from edges to uint64_t values, to keep track of the edges stored in the graph during the generation. Each
+ * edge is packed in a uint64_t key and stored inline, together with its value, in a single array with linear probing.
+ * The array is sized once at construction time, to keep the load factor at most 3/4. Removals shift back the
+ * following entries of the cluster, rather than leaving tombstones, so that the probe sequences do not degrade over
+ * a long series of insertions and deletions.
+ *
+ * The self loop [2^32-1, 2^32-1] cannot be stored, its key marks the empty slots.
+ *
+ * The class is not thread safe
+ */
+class EdgeMap {
+    EdgeMap(const EdgeMap&) = delete;
+    EdgeMap& operator=(const EdgeMap&) = delete;
+
+    struct Slot {
+        uint64_t m_key;
+        uint64_t m_value;
+    };
+
+    constexpr static uint64_t EMPTY = static_cast<uint64_t>(-1); // marker for the empty slots
+    Slot* m_slots = nullptr; // the actual content of the map
+    uint64_t m_capacity_mask = 0; // number of slots - 1, the number of slots is a power of 2
+    uint64_t m_size = 0; // number of entries stored
+    const uint64_t m_max_size; // max number of entries that can be stored
+
+    // Pack the endpoints of the edge in a single key
+    static uint64_t key(Edge edge);
+
+    // The home slot of the key. The hash of the key is the same of std::hash<Edge>, it spreads the edges of the same
+    // source across the whole table
+    uint64_t home(uint64_t key) const { return mix64(key) & m_capacity_mask; }
+
+    // Retrieve the slot for the given key, either the slot storing the key or the empty slot where it would be stored
+    Slot* probe(uint64_t key) const;
+
+public:
+    // Create a map that can store up to `max_size' edges
+    EdgeMap(uint64_t max_size);
+
+    // Destructor
+    ~EdgeMap();
+
+    // Insert or replace the value associated to the given edge
+    void insert(Edge edge, uint64_t value);
+
+    // Retrieve the value associated to the given edge. Return false if the edge is not present
+    bool find(Edge edge, uint64_t* out_value) const;
+
+    // Check whether the given edge is present
+    bool contains(Edge edge) const;
+
+    // Remove the given edge. Return false if the edge was not present
+    bool remove(Edge edge);
+
+    // Number of entries stored
+    uint64_t size() const { return m_size; }
+
+    // Number of entries stored w.r.t. the number of slots
+    double load_factor() const;
+
+    // Memory footprint of the map, in bytes
+    uint64_t footprint() const;
+
+    // Number of slots allocated to store up to `max_size' edges
+    static uint64_t capacity(uint64_t max_size);
+};
@@ -0,0 +1,320 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "edge_shuffle.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <random>
+
+#include "lib/common/error.hpp"
+#include "hash.hpp"
+#include "parallel.hpp"
+#include "scratch_file.hpp"
+
+using namespace std;
+
+/*****************************************************************************
+ *                                                                           *
+ *  Init                                                                     *
+ *                                                                           *
+ *****************************************************************************/
+
+template<typename E>
+EdgeShuffle<E>::EdgeShuffle(uint64_t max_num_edges, uint64_t block_capacity, uint64_t seed, const std::string& scratch_directory) :
+        m_block_capacity(block_capacity), m_max_num_edges(max_num_edges),
+        m_num_buckets(block_capacity == 0 ? 1 : std::max<uint64_t>(1, (max_num_edges + block_capacity -1) / block_capacity)),
+        m_seed(seed), m_scratch_directory(scratch_directory) {
+    if(block_capacity == 0) INVALID_ARGUMENT("The capacity of the blocks must be greater than 0");
+    if(m_num_buckets > numeric_limits<uint32_t>::max()) INVALID_ARGUMENT("Too many buckets: " << m_num_buckets);
+
+    m_buckets = (Bucket*) calloc(m_num_buckets, sizeof(Bucket));
+    if(m_buckets == nullptr) throw bad_alloc();
+
+    // the size of the buckets follows a binomial distribution, leave some room for its deviation
+    uint64_t mean_bucket_sz = max_num_edges / m_num_buckets + 1;
+    uint64_t initial_capacity = mean_bucket_sz + 4 * static_cast<uint64_t>(sqrt(mean_bucket_sz)) + 64;
+    if(is_external()){
+        initial_capacity = std::min(initial_capacity, spill_buffer_capacity());
+        m_spill.reset( new ScratchFile<E>(m_scratch_directory) );
+        m_spilled_chunks.resize(m_num_buckets);
+    }
+    for(uint64_t i = 0; i < m_num_buckets; i++){
+        ensure_capacity(m_buckets[i], initial_capacity);
+    }
+}
+
+template<typename E>
+EdgeShuffle<E>::~EdgeShuffle(){
+    if(m_buckets != nullptr){
+        for(uint64_t i = 0; i < m_num_buckets; i++){ free(m_buckets[i].m_edges); }
+        free(m_buckets);
+        m_buckets = nullptr;
+    }
+    if(m_blocks != nullptr){
+        for(uint64_t i = 0; i < m_num_blocks; i++){ free(m_blocks[i]); }
+        free(m_blocks);
+        m_blocks = nullptr;
+    }
+}
+
+template<typename E>
+void EdgeShuffle<E>::ensure_capacity(Bucket& bucket, uint64_t capacity){
+    if(capacity <= bucket.m_capacity) return;
+    capacity = std::max(capacity, bucket.m_capacity + bucket.m_capacity / 4);
+    E* edges = (E*) realloc(bucket.m_edges, capacity * sizeof(E));
+    if(edges == nullptr) throw bad_alloc();
+    bucket.m_edges = edges;
+    bucket.m_capacity = capacity;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  First pass                                                               *
+ *                                                                           *
+ *****************************************************************************/
+
+template<typename E>
+uint32_t EdgeShuffle<E>::get_bucket(uint64_t edge_id) const {
+    // splitmix64, a counter based generator: the bucket of an edge does not depend on the buckets of the other edges
+    uint64_t x = splitmix64(m_seed + (edge_id +1) * 0x9e3779b97f4a7c15ULL);
+    return static_cast<uint32_t>((static_cast<unsigned __int128>(x) * m_num_buckets) >> 64); // in [0, m_num_buckets)
+}
+
+template<typename E>
+void EdgeShuffle<E>::reserve(uint64_t count, E** out_positions, uint64_t num_threads){
+    if(count > m_max_num_edges - m_num_edges) ERROR("Too many edges, max capacity: " << m_max_num_edges);
+    if(m_buckets == nullptr) ERROR("The edges have already been shuffled");
+    if(is_external()) flush_buckets(); // the positions previously reserved have been written
+
+    if(m_num_buckets == 1){ // trivial case
+        Bucket& bucket = m_buckets[0];
+        ensure_capacity(bucket, bucket.m_size + count);
+        for(uint64_t i = 0; i < count; i++){ out_positions[i] = bucket.m_edges + bucket.m_size + i; }
+        bucket.m_size += count;
+        m_num_edges += count;
+        return;
+    }
+
+    // the edges are split into partitions, each with its own histogram of the buckets
+    const uint64_t num_partitions = std::max<uint64_t>(1, std::min(num_threads, count));
+    m_bucket_ids.resize(count);
+    m_histograms.assign(num_partitions * m_num_buckets, 0);
+    auto for_each_partition = [&](auto fn){
+        parallel_for(num_partitions, num_partitions, [&](uint64_t start, uint64_t end){
+            for(uint64_t p = start; p < end; p++){
+                fn(count * p / num_partitions, count * (p +1) / num_partitions, m_histograms.data() + p * m_num_buckets);
+            }
+        });
+    };
+
+    // count the edges of each partition assigned to each bucket
+    for_each_partition([&](uint64_t start, uint64_t end, uint64_t* __restrict histogram){
+        for(uint64_t i = start; i < end; i++){
+            uint32_t bucket_id = get_bucket(m_num_edges + i);
+            m_bucket_ids[i] = bucket_id;
+            histogram[bucket_id]++;
+        }
+    });
+
+    // turn the histograms into the offsets where each partition appends its edges, preserving the order of the input
+    for(uint64_t bucket_id = 0; bucket_id < m_num_buckets; bucket_id++){
+        Bucket& bucket = m_buckets[bucket_id];
+        uint64_t offset = bucket.m_size;
+        for(uint64_t p = 0; p < num_partitions; p++){
+            uint64_t& histogram = m_histograms[p * m_num_buckets + bucket_id];
+            uint64_t partition_sz = histogram;
+            histogram = offset;
+            offset += partition_sz;
+        }
+        ensure_capacity(bucket, offset);
+        bucket.m_size = offset;
+    }
+
+    // assign the positions
+    for_each_partition([&](uint64_t start, uint64_t end, uint64_t* __restrict offsets){
+        for(uint64_t i = start; i < end; i++){
+            uint32_t bucket_id = m_bucket_ids[i];
+            out_positions[i] = m_buckets[bucket_id].m_edges + offsets[bucket_id]++;
+        }
+    });
+
+    m_num_edges += count;
+}
+
+template<typename E>
+void EdgeShuffle<E>::flush_buckets(){
+    assert(is_external());
+    for(uint64_t bucket_id = 0; bucket_id < m_num_buckets; bucket_id++){
+        Bucket& bucket = m_buckets[bucket_id];
+        if(bucket.m_size < m_spill_threshold) continue;
+        m_spilled_chunks[bucket_id].push_back(SpilledChunk{ m_spill->num_edges(), bucket.m_size });
+        m_spill->append(bucket.m_edges, bucket.m_size);
+        bucket.m_num_spilled += bucket.m_size;
+        bucket.m_size = 0;
+    }
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Second pass                                                              *
+ *                                                                           *
+ *****************************************************************************/
+
+template<typename E>
+void EdgeShuffle<E>::shuffle_bucket(uint64_t bucket_id, E* __restrict edges, uint64_t num_edges) const {
+    // each bucket has its own random generator, so that the result does not depend on the number of threads
+    seed_seq seed { static_cast<uint32_t>(m_seed), static_cast<uint32_t>(m_seed >> 32), static_cast<uint32_t>(bucket_id) };
+    mt19937_64 random { seed };
+    for(uint64_t i = num_edges; i > 1; i--){
+        uint64_t j = uniform_int_distribution<uint64_t>{0, i -1}(random);
+        std::swap(edges[i -1], edges[j]);
+    }
+}
+
+template<typename E>
+void EdgeShuffle<E>::shuffle(uint64_t num_threads){
+    if(m_buckets == nullptr) ERROR("The edges have already been shuffled");
+    m_bucket_ids.clear(); m_bucket_ids.shrink_to_fit();
+    m_histograms.clear(); m_histograms.shrink_to_fit();
+
+    if(is_external()){
+        shuffle_into_file(num_threads);
+        return;
+    }
+
+    parallel_for(num_threads, m_num_buckets, [this](uint64_t start, uint64_t end){
+        for(uint64_t bucket_id = start; bucket_id < end; bucket_id++){
+            shuffle_bucket(bucket_id, m_buckets[bucket_id].m_edges, m_buckets[bucket_id].m_size);
+        }
+    });
+
+    split_into_blocks(num_threads);
+}
+
+template<typename E>
+void EdgeShuffle<E>::split_into_blocks(uint64_t num_threads){
+    assert(m_blocks == nullptr);
+    m_num_blocks = m_num_edges / m_block_capacity + (m_num_edges % m_block_capacity != 0);
+    m_blocks = (E**) calloc(std::max<uint64_t>(1, m_num_blocks), sizeof(E*));
+    if(m_blocks == nullptr) throw bad_alloc();
+
+    // position of each bucket in the concatenation
+    vector<uint64_t> bucket_start(m_num_buckets +1, 0);
+    for(uint64_t i = 0; i < m_num_buckets; i++){ bucket_start[i +1] = bucket_start[i] + m_buckets[i].m_size; }
+    assert(bucket_start[m_num_buckets] == m_num_edges);
+
+    // create the blocks in waves of `num_threads', to release the buckets as soon as they have been copied
+    num_threads = std::max<uint64_t>(1, num_threads);
+    uint64_t num_buckets_released = 0;
+    for(uint64_t wave_start = 0; wave_start < m_num_blocks; wave_start += num_threads){
+        uint64_t wave_end = std::min(m_num_blocks, wave_start + num_threads);
+        parallel_for(num_threads, wave_end - wave_start, [&](uint64_t start, uint64_t end){
+            for(uint64_t block_id = wave_start + start; block_id < wave_start + end; block_id++){
+                uint64_t block_start = block_id * m_block_capacity;
+                uint64_t block_sz = std::min(m_block_capacity, m_num_edges - block_start);
+                E* block = (E*) malloc(block_sz * sizeof(E));
+                if(block == nullptr) throw bad_alloc();
+                m_blocks[block_id] = block;
+
+                uint64_t bucket_id = std::upper_bound(bucket_start.begin(), bucket_start.end(), block_start) - bucket_start.begin() -1;
+                uint64_t num_copied = 0;
+                while(num_copied < block_sz){
+                    assert(bucket_id < m_num_buckets);
+                    uint64_t offset = block_start + num_copied - bucket_start[bucket_id];
+                    uint64_t count = std::min(block_sz - num_copied, m_buckets[bucket_id].m_size - offset);
+                    memcpy(block + num_copied, m_buckets[bucket_id].m_edges + offset, count * sizeof(E));
+                    num_copied += count;
+                    bucket_id++;
+                }
+            }
+        });
+
+        uint64_t copied_end = std::min(m_num_edges, wave_end * m_block_capacity);
+        while(num_buckets_released < m_num_buckets && bucket_start[num_buckets_released +1] <= copied_end){
+            free(m_buckets[num_buckets_released].m_edges); m_buckets[num_buckets_released].m_edges = nullptr;
+            num_buckets_released++;
+        }
+    }
+
+    for(uint64_t i = num_buckets_released; i < m_num_buckets; i++){ free(m_buckets[i].m_edges); }
+    free(m_buckets); m_buckets = nullptr;
+}
+
+template<typename E>
+void EdgeShuffle<E>::shuffle_into_file(uint64_t num_threads){
+    assert(is_external());
+    m_output.reset( new ScratchFile<E>(m_scratch_directory) );
+    m_output->resize(m_num_edges);
+
+    // position of each bucket in the concatenation
+    vector<uint64_t> bucket_start(m_num_buckets +1, 0);
+    for(uint64_t i = 0; i < m_num_buckets; i++){ bucket_start[i +1] = bucket_start[i] + m_buckets[i].m_num_spilled + m_buckets[i].m_size; }
+    assert(bucket_start[m_num_buckets] == m_num_edges);
+
+    // load, shuffle and store the buckets in waves of `num_threads', to keep at most one bucket in memory per thread
+    num_threads = std::max<uint64_t>(1, num_threads);
+    for(uint64_t wave_start = 0; wave_start < m_num_buckets; wave_start += num_threads){
+        uint64_t wave_end = std::min(m_num_buckets, wave_start + num_threads);
+        parallel_for(num_threads, wave_end - wave_start, [&](uint64_t start, uint64_t end){
+            for(uint64_t bucket_id = wave_start + start; bucket_id < wave_start + end; bucket_id++){
+                Bucket& bucket = m_buckets[bucket_id];
+                uint64_t num_edges = bucket.m_num_spilled + bucket.m_size;
+                unique_ptr<E[]> ptr_edges { new E[num_edges] };
+                E* edges = ptr_edges.get();
+
+                // the chunks flushed to the scratch file come first, then the edges still in memory
+                uint64_t num_loaded = 0;
+                for(const SpilledChunk& chunk : m_spilled_chunks[bucket_id]){
+                    m_spill->read(chunk.m_position, edges + num_loaded, chunk.m_num_edges);
+                    num_loaded += chunk.m_num_edges;
+                }
+                memcpy(edges + num_loaded, bucket.m_edges, bucket.m_size * sizeof(E));
+                free(bucket.m_edges); bucket.m_edges = nullptr;
+
+                shuffle_bucket(bucket_id, edges, num_edges);
+                m_output->write(bucket_start[bucket_id], edges, num_edges);
+            }
+        });
+    }
+
+    free(m_buckets); m_buckets = nullptr;
+    m_spill.reset();
+    m_spilled_chunks.clear();
+}
+
+template<typename E>
+E** EdgeShuffle<E>::release(){
+    E** blocks = m_blocks;
+    m_blocks = nullptr;
+    m_num_blocks = 0;
+    return blocks;
+}
+
+template<typename E>
+std::unique_ptr<ScratchFile<E>> EdgeShuffle<E>::release_file(){
+    return std::move(m_output);
+}
+
+// explicit instantiations
+template class EdgeShuffle<Edge>;
+template class EdgeShuffle<WeightedEdge>;
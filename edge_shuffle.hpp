@@ -0,0 +1,150 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "edge.hpp"
+
+template<typename E> class ScratchFile; // forward decl.
+
+/**
+ * Random permutation of the final edges, performed while they are loaded (shuffle on load), with a bucketed two-pass
+ * scheme (Rao-Sandelius). In the first pass, each edge is appended to a random bucket, determined by hashing the seed
+ * together with the position of the edge in the input. In the second pass, each bucket is shuffled locally, and the
+ * concatenation of the buckets is split into blocks of fixed capacity. Altogether, this is a uniform random permutation
+ * of the edges, which only depends on the seed and on the order the edges are loaded. Both passes run in parallel and
+ * their result does not depend on the number of threads. The memory footprint is about one copy of the edges.
+ *
+ * In external memory mode, the buckets are flushed to a scratch file as they grow, and the shuffled edges are stored
+ * in another scratch file rather than in blocks. The memory footprint is then bounded by a small buffer for each
+ * bucket during the first pass, and by a bucket for each thread during the second pass. The result is the same of
+ * the in-memory mode.
+ *
+ * The class is not thread safe, but the positions returned by #reserve can be written concurrently. It is instantiated
+ * for the types Edge and WeightedEdge.
+ */
+template<typename E>
+class EdgeShuffle {
+    EdgeShuffle(const EdgeShuffle&) = delete;
+    EdgeShuffle& operator=(const EdgeShuffle&) = delete;
+
+    struct Bucket {
+        E* m_edges; // the edges appended to the bucket
+        uint64_t m_size; // number of edges in the bucket, still in memory
+        uint64_t m_capacity; // max number of edges that can be stored in the bucket, before resizing it
+        uint64_t m_num_spilled; // external memory, number of edges of the bucket already flushed to the scratch file
+    };
+
+    // External memory, a sequence of edges of a bucket flushed to the scratch file
+    struct SpilledChunk {
+        uint64_t m_position; // position in the scratch file, in number of edges
+        uint64_t m_num_edges; // number of edges in the chunk
+    };
+
+    // External memory, flush a bucket to the scratch file once it reaches this number of edges
+    static constexpr uint64_t m_spill_threshold = (1ull << 14);
+
+    const uint64_t m_block_capacity; // max number of edges in each block
+    const uint64_t m_max_num_edges; // max number of edges that can be loaded
+    const uint64_t m_num_buckets; // total number of buckets
+    const uint64_t m_seed; // seed for the random generators
+    Bucket* m_buckets = nullptr; // the buckets, first pass
+    E** m_blocks = nullptr; // the blocks of edges, second pass
+    uint64_t m_num_blocks = 0; // number of blocks in m_blocks
+    uint64_t m_num_edges = 0; // number of edges loaded so far
+    std::vector<uint32_t> m_bucket_ids; // scratch space for #reserve, the bucket of each edge being reserved
+    std::vector<uint64_t> m_histograms; // scratch space for #reserve, the number of edges per bucket in each partition
+    const std::string m_scratch_directory; // where to store the scratch files, empty for the in-memory mode
+    std::unique_ptr<ScratchFile<E>> m_spill; // external memory, the chunks flushed from the buckets, first pass
+    std::vector<std::vector<SpilledChunk>> m_spilled_chunks; // external memory, the chunks of each bucket in m_spill
+    std::unique_ptr<ScratchFile<E>> m_output; // external memory, the shuffled edges, second pass
+
+    // The bucket assigned to the edge at the given position in the input
+    uint32_t get_bucket(uint64_t edge_id) const;
+
+    // Ensure the given bucket can store at least `capacity' edges
+    void ensure_capacity(Bucket& bucket, uint64_t capacity);
+
+    // External memory, flush the buckets that reached the spill threshold
+    void flush_buckets();
+
+    // Shuffle the content of the given array of edges, with the random generator of the given bucket
+    void shuffle_bucket(uint64_t bucket_id, E* edges, uint64_t num_edges) const;
+
+    // Split the concatenation of the buckets into the final blocks, releasing the buckets
+    void split_into_blocks(uint64_t num_threads);
+
+    // External memory, shuffle the buckets and store their concatenation in the output file, releasing the buckets
+    void shuffle_into_file(uint64_t num_threads);
+
+public:
+    /**
+     * Create a new instance
+     * @param max_num_edges the max number of edges that can be loaded
+     * @param block_capacity the number of edges in each block, except the last
+     * @param seed the seed for the random generators
+     * @param scratch_directory if not empty, operate in external memory mode, storing the scratch files in this directory
+     */
+    EdgeShuffle(uint64_t max_num_edges, uint64_t block_capacity, uint64_t seed, const std::string& scratch_directory = std::string());
+
+    // Destructor
+    ~EdgeShuffle();
+
+    /**
+     * Reserve the positions of the next `count' edges loaded, storing them in `out_positions'. The edges are assigned
+     * to the buckets by up to `num_threads' threads. In external memory mode, the positions are only valid until the
+     * next invocation of #reserve or #shuffle.
+     */
+    void reserve(uint64_t count, E** out_positions, uint64_t num_threads);
+
+    /**
+     * Shuffle the content of each bucket and split the result into blocks, once all edges have been loaded. The work
+     * is performed by up to `num_threads' threads, the result does not depend on the number of threads used.
+     */
+    void shuffle(uint64_t num_threads);
+
+    /**
+     * Transfer the ownership of the blocks to the caller. They must be deallocated with free(). All blocks contain
+     * exactly `block_capacity' edges, except the last one. Only for the in-memory mode.
+     */
+    E** release();
+
+    /**
+     * Transfer the ownership of the file with the shuffled edges to the caller. Only for the external memory mode.
+     */
+    std::unique_ptr<ScratchFile<E>> release_file();
+
+    /**
+     * External memory, the max number of edges buffered in memory for each bucket during the first pass
+     */
+    static constexpr uint64_t spill_buffer_capacity() { return 2 * m_spill_threshold; }
+
+    /**
+     * Whether the instance operates in external memory mode
+     */
+    bool is_external() const { return !m_scratch_directory.empty(); }
+
+    /**
+     * Total number of edges loaded
+     */
+    uint64_t num_edges() const { return m_num_edges; }
+};
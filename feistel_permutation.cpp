@@ -0,0 +1,35 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "feistel_permutation.hpp"
+
+#include <random>
+
+#include "lib/common/error.hpp"
+
+using namespace std;
+
+FeistelPermutation::FeistelPermutation(uint64_t size, uint64_t seed) : m_size(size) {
+    if(size > (1ull << 62)) INVALID_ARGUMENT("The domain is too large: " << size);
+
+    m_half_bits = 1;
+    while((1ull << (2 * m_half_bits)) < size){ m_half_bits++; }
+    m_half_mask = (1ull << m_half_bits) -1;
+
+    mt19937_64 random { seed };
+    for(uint64_t i = 0; i < m_num_rounds; i++){ m_keys[i] = random(); }
+}
@@ -0,0 +1,75 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cinttypes>
+
+#include "hash.hpp"
+
+/**
+ * Keyed pseudo-random bijection over the domain [0, size), to visit a sequence in a random order without materialising
+ * the permutation. The bijection is a balanced Feistel network over the smallest domain of 2^(2b) elements containing
+ * [0, size). Values falling outside [0, size) are mapped again (cycle walking) until they fall inside the domain.
+ * As 2^(2b) < 4 * size, on average less than four rounds of the network are required for each index.
+ */
+class FeistelPermutation {
+    static constexpr uint64_t m_num_rounds = 4; // number of rounds in the Feistel network
+    const uint64_t m_size; // the size of the domain
+    uint64_t m_half_bits; // the number of bits in each half of the network
+    uint64_t m_half_mask; // mask to extract the lower half of a value
+    uint64_t m_keys[m_num_rounds]; // the key for each round
+
+    // The round function of the network
+    static uint64_t round(uint64_t value, uint64_t key){
+        return splitmix64(value + key);
+    }
+
+    // One pass through the network, a bijection over [0, 2^(2 * m_half_bits))
+    uint64_t encrypt(uint64_t value) const {
+        uint64_t left = value >> m_half_bits;
+        uint64_t right = value & m_half_mask;
+        for(uint64_t i = 0; i < m_num_rounds; i++){
+            uint64_t tmp = right;
+            right = left ^ (round(right, m_keys[i]) & m_half_mask);
+            left = tmp;
+        }
+        return (left << m_half_bits) | right;
+    }
+
+public:
+    /**
+     * Create a new bijection over [0, size), determined by the given seed
+     */
+    FeistelPermutation(uint64_t size, uint64_t seed);
+
+    /**
+     * Map the given index, in [0, size), to its position in the permutation, also in [0, size)
+     */
+    uint64_t operator()(uint64_t index) const {
+        assert(index < m_size && "Index out of bounds");
+        uint64_t value = index;
+        do { value = encrypt(value); } while(value >= m_size);
+        return value;
+    }
+
+    /**
+     * The size of the domain
+     */
+    uint64_t size() const { return m_size; }
+};
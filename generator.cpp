@@ -19,18 +19,30 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
-#include <unordered_map>
+#include <type_traits>
 #include <utility>
 
-#include "lib/common/permutation.hpp"
 #include "lib/common/timer.hpp"
-#include "abtree.hpp"
+#include "alias_table.hpp"
+#include "degree_buckets.hpp"
+#include "edge_map.hpp"
+#include "edge_shuffle.hpp"
+#include "feistel_permutation.hpp"
 #include "graphalytics_reader.hpp"
+#include "input_cache.hpp"
 #include "output_buffer.hpp"
+#include "parallel.hpp"
+#include "scratch_file.hpp"
+#include "statistics.hpp"
+#include "temporary_edges.hpp"
+#include "vertex_sampler.hpp"
+#include "vertex_map.hpp"
 #include "writer.hpp"
 
 using namespace common;
@@ -64,28 +76,53 @@ struct InitVertexRecord {
     uint32_t m_offset;
     uint32_t m_frequency;
 };
+
+// Translate the vertex ids with a direct-indexed table when their range is less than this factor times the number of vertices
+constexpr uint64_t dense_ids_max_sparsity = 4;
 }
 
-Generator::Generator(const std::string& path_input_graph, const std::string& path_output_log, Writer& writer, double sf_frequency, double ef_vertices, double ef_edges, double aging_factor, uint64_t seed) :
-    m_writer(writer), m_num_operations(0), m_seed(seed), m_random(m_seed){
-    unordered_map<uint64_t, InitVertexRecord> map_frequencies;
-    unique_ptr<WeightedEdge[]> ptr_weighted_edges;
+template<typename WeightPolicy>
+Generator<WeightPolicy>::Generator(const std::string& path_input_graph, const std::string& path_output_log, Writer& writer, const GeneratorOptions& options, double sf_frequency, double ef_vertices, double ef_edges, double aging_factor, uint64_t seed) :
+    m_writer(writer), m_options(options), m_num_operations(0), m_seed(seed), m_random(m_seed){
+    unique_ptr<InitVertexRecord[]> array_frequencies;
+    unique_ptr<EdgeShuffle<edge_t>> edges_shuffle; // permute the final edges while they are loaded, with --edge-order shuffle
 
-    init_read_input_graph(&ptr_weighted_edges, &map_frequencies, path_input_graph, ef_vertices);
+    if(!m_options.m_input_cache || !init_load_cache(&array_frequencies, edges_shuffle, path_input_graph, ef_vertices)){
+        init_read_input_graph(&array_frequencies, edges_shuffle, path_input_graph, ef_vertices);
+    }
 
     m_num_max_edges = ef_edges * m_num_edges_final;
     m_num_operations = aging_factor * m_num_edges_final;
 
-    unique_ptr<InitVertexRecord[]> array_frequencies { new InitVertexRecord[num_vertices()] };
-    init_temporary_vertices(&map_frequencies, array_frequencies.get(), sf_frequency);
-    init_counting_tree(array_frequencies.get());
+    init_temporary_vertices(array_frequencies.get(), sf_frequency);
+    switch(m_options.m_vertex_sampler){
+    case VertexSamplerType::ALIAS:
+        init_alias_table(array_frequencies.get());
+        break;
+    case VertexSamplerType::DEGREE_BUCKETS:
+        init_degree_buckets(array_frequencies.get());
+        break;
+    case VertexSamplerType::COUNTING_TREE:
+        init_counting_tree(array_frequencies.get());
+        break;
+    }
 
-    init_permute_edges_final(ptr_weighted_edges);
+    if(edges_shuffle){
+        init_permute_edges_final(*edges_shuffle, m_edges_final_input);
+
+        // the edges in the order of the input are not needed anymore
+        m_edges_final_input = nullptr;
+        m_edges_final_input_array.reset();
+        m_input_cache.reset();
+    } else {
+        init_order_edges_final();
+    }
 
     init_writer(path_output_log);
 }
 
-Generator::~Generator(){
+template<typename WeightPolicy>
+Generator<WeightPolicy>::~Generator(){
     delete m_frequencies; m_frequencies = nullptr;
     delete[] m_vertices; m_vertices = nullptr;
 
@@ -98,92 +135,252 @@ Generator::~Generator(){
     }
 }
 
-void Generator::init_read_input_graph(void* ptr_array_edges, void* ptr_frequencies, const std::string& path_input_graph, double expansion_factor_vertices) {
+template<typename WeightPolicy>
+void Generator<WeightPolicy>::init_read_input_graph(void* ptr_array_frequencies, std::unique_ptr<EdgeShuffle<edge_t>>& edges_shuffle, const std::string& path_input_graph, double expansion_factor_vertices) {
     LOG("Reading the input graph from: " << path_input_graph << " ... ");
     Timer timer;
     timer.start();
+    Statistics::Phase phase_stats { "init_read_input_graph" };
 
-    assert(ptr_array_edges != nullptr);
-    auto& ptr_edges_final = *reinterpret_cast<unique_ptr<WeightedEdge[]>*>(ptr_array_edges);
-    assert(ptr_frequencies != nullptr);
-    auto& frequencies = *reinterpret_cast<unordered_map<uint64_t, InitVertexRecord>*>(ptr_frequencies);
+    assert(ptr_array_frequencies != nullptr);
+    auto& array_frequencies = *reinterpret_cast<unique_ptr<InitVertexRecord[]>*>(ptr_array_frequencies);
 
-    GraphalyticsReader reader{path_input_graph};
+    GraphalyticsReader reader{path_input_graph, m_options.m_init_threads, m_options.m_reader_buffer_size};
     if(reader.is_directed()) ERROR("Only undirected graphs are supported. The input graph `" << path_input_graph << "' is directed");
 
     string prop_num_vertices = reader.get_property("meta.vertices");
-    m_num_vertices_final = stoi(prop_num_vertices);
+    m_num_vertices_final = stoull(prop_num_vertices);
     string prop_num_edges = reader.get_property("meta.edges");
     m_num_vertices_temporary = ceil( (expansion_factor_vertices - 1.0) * m_num_vertices_final );
     if(num_vertices() > std::numeric_limits<uint32_t>::max()) {
         ERROR("Too many vertices: " << num_vertices() << ", vertices in the final graph: " << num_final_vertices() << ", expansion factor: " << expansion_factor_vertices);
     }
 
-    m_num_edges_final = stoi(prop_num_edges);
+    m_num_edges_final = stoull(prop_num_edges);
     COUT_DEBUG("num vertices final graph: " << num_final_vertices() << ", num edges final graph: " << m_num_edges_final);
 
     m_vertices = new uint64_t[num_vertices()];
-    ptr_edges_final.reset( new WeightedEdge[m_num_edges_final] );
-    WeightedEdge* __restrict edges_final = ptr_edges_final.get();
+
+    // the edges are scattered in `edges_shuffle' as they are read. Only when they need to be saved in the cache, or
+    // when they are visited through a bijection, they are stored in a flat array, in the same order of the input
+    edge_t* __restrict edges_final = nullptr;
+    if(m_options.m_input_cache || m_options.m_edge_order == EdgeOrder::FEISTEL){
+        m_edges_final_input_array.reset( new edge_t[m_num_edges_final] );
+        edges_final = m_edges_final_input_array.get();
+        m_edges_final_input = edges_final;
+    }
+    if(m_options.m_edge_order == EdgeOrder::SHUFFLE){
+        edges_shuffle.reset( new EdgeShuffle<edge_t>(m_num_edges_final, m_num_final_edges_per_block, m_seed + 57, m_options.m_scratch_directory) );
+    }
 
     uint32_t vertex_next = 0;
     uint64_t edge_next = 0;
-    uint64_t vertex, source, destination;
-    double weight;
 
-    while(reader.read_vertex(vertex)){
-        m_vertices[vertex_next] = vertex;
-        frequencies[vertex] = InitVertexRecord{vertex_next, 0};
-        vertex_next++;
+    // the vertices & edges are fetched from the reader in batches, each batch of edges is processed by multiple threads
+    const uint64_t num_threads = m_options.m_init_threads;
+    const uint64_t batch_capacity = (1ull << 16) * num_threads;
+    unique_ptr<uint64_t[]> ptr_batch { new uint64_t[3 * batch_capacity] };
+    uint64_t* __restrict batch_sources = ptr_batch.get();
+    uint64_t* __restrict batch_destinations = batch_sources + batch_capacity;
+    double* __restrict batch_weights = reinterpret_cast<double*>(batch_destinations + batch_capacity);
+    unique_ptr<edge_t*[]> ptr_batch_targets { new edge_t*[batch_capacity] }; // where to store each edge of the batch
+    edge_t** __restrict batch_targets = ptr_batch_targets.get();
+    uint64_t batch_sz = 0;
+
+    uint64_t* __restrict batch_vertices = batch_sources;
+    uint64_t vertex_min = numeric_limits<uint64_t>::max();
+    uint64_t vertex_max = 0;
+    while((batch_sz = reader.read_vertices(batch_vertices, batch_capacity)) > 0){
+        if(vertex_next + batch_sz > num_final_vertices()) ERROR("The vertex list contains more vertices than stated in the property file: " << num_final_vertices());
+        for(uint64_t i = 0; i < batch_sz; i++){
+            uint64_t vertex = batch_vertices[i];
+            m_vertices[vertex_next] = vertex;
+            vertex_min = std::min(vertex_min, vertex);
+            vertex_max = std::max(vertex_max, vertex);
+            vertex_next++;
+        }
+    }
+    m_num_vertices_final = vertex_next; // actual number of vertices read in the final graph
+
+    // from now on, the vertices are only accessed by their dense id
+    array_frequencies.reset( new InitVertexRecord[num_vertices()] );
+    for(uint32_t i = 0; i < num_final_vertices(); i++){
+        array_frequencies[i] = InitVertexRecord{i, 0};
     }
 
-    while(reader.read_edge(source, destination, weight)){
-        assert(source != destination && "The edge has the same source & destination");
-        assert(frequencies.count(source) > 0 && "This vertex is not present in the vertex list");
-        assert(frequencies.count(destination) > 0 && "This vertex is not present in the vertex list");
+    // translate the endpoints of the edges into dense ids, through the given functor. The functor replaces, in place,
+    // a batch of external vertex ids with their dense ids and it must be safe to invoke concurrently
+    auto read_edges = [&](auto&& translate){
+        // process the edges in [start, end) of the current batch. With concurrent workers, the degrees are
+        // incremented atomically. Their final value does not depend on the order of the increments.
+        auto process_edges = [&](uint64_t start, uint64_t end, auto is_concurrent){
+            translate(batch_sources + start, end - start);
+            translate(batch_destinations + start, end - start);
+
+            for(uint64_t i = start; i < end; i++){
+                uint32_t src_id = batch_sources[i];
+                uint32_t dst_id = batch_destinations[i];
+                assert(src_id != dst_id && "The edge has the same source & destination");
+                if constexpr (decltype(is_concurrent)::value) {
+                    __atomic_fetch_add(&(array_frequencies[src_id].m_frequency), 1, __ATOMIC_RELAXED);
+                    __atomic_fetch_add(&(array_frequencies[dst_id].m_frequency), 1, __ATOMIC_RELAXED);
+                } else {
+                    array_frequencies[src_id].m_frequency++;
+                    array_frequencies[dst_id].m_frequency++;
+                }
 
-        frequencies[source].m_frequency++;
-        frequencies[destination].m_frequency++;
+                if(dst_id < src_id) swap(src_id, dst_id);
+                *(batch_targets[i]) = WeightPolicy::make_edge(src_id, dst_id, batch_weights[i]);
+            }
+        };
+
+        while((batch_sz = reader.read_edges(batch_sources, batch_destinations, batch_weights, batch_capacity)) > 0){
+            if(edge_next + batch_sz > m_num_edges_final) ERROR("The edge list contains more edges than stated in the property file: " << m_num_edges_final);
+
+            if(edges_final != nullptr){
+                for(uint64_t i = 0; i < batch_sz; i++){ batch_targets[i] = edges_final + edge_next + i; }
+            } else {
+                edges_shuffle->reserve(batch_sz, batch_targets, num_threads);
+            }
+
+            if(num_threads == 1){
+                process_edges(0, batch_sz, std::false_type{});
+            } else {
+                parallel_for(num_threads, batch_sz, [&](uint64_t start, uint64_t end){ process_edges(start, end, std::true_type{}); });
+            }
+
+            edge_next += batch_sz;
+        }
+    };
+
+    // when the vertex ids are contiguous, or nearly so, translate them with a direct-indexed table rather than a hash map
+    if(vertex_next > 0 && (vertex_max - vertex_min) / dense_ids_max_sparsity < vertex_next){
+        uint64_t vertex_range = vertex_max - vertex_min +1;
+        COUT_DEBUG("Vertex ids in [" << vertex_min << ", " << vertex_max << "], translated with a direct-indexed table");
+        constexpr uint32_t NOT_FOUND = numeric_limits<uint32_t>::max();
+        unique_ptr<uint32_t[]> ptr_dense_ids { new uint32_t[vertex_range] };
+        uint32_t* __restrict dense_ids = ptr_dense_ids.get();
+        std::fill(dense_ids, dense_ids + vertex_range, NOT_FOUND);
+        for(uint32_t i = 0; i < vertex_next; i++){
+            dense_ids[m_vertices[i] - vertex_min] = i;
+        }
 
-        uint32_t src_id = frequencies[source].m_offset;
-        uint32_t dst_id = frequencies[destination].m_offset;
-        assert(src_id != dst_id);
-        if(dst_id < src_id) swap(src_id, dst_id);
+        read_edges([&](uint64_t* vertices, uint64_t count){
+            for(uint64_t i = 0; i < count; i++){
+                uint64_t index = vertices[i] - vertex_min; // wraps around when vertex < vertex_min
+                uint32_t dense_id = (index < vertex_range) ? dense_ids[index] : NOT_FOUND;
+                if(dense_id == NOT_FOUND) ERROR("The vertex " << vertices[i] << " is not present in the vertex list");
+                vertices[i] = dense_id;
+            }
+        });
+    } else {
+        COUT_DEBUG("Vertex ids in [" << vertex_min << ", " << vertex_max << "], translated with a hash map");
+        VertexMap dense_ids { num_final_vertices() }; // external vertex id -> dense id
+        for(uint32_t i = 0; i < vertex_next; i++){
+            dense_ids.insert(m_vertices[i], i);
+        }
 
-        assert(edge_next < m_num_edges_final);
-        edges_final[edge_next] = WeightedEdge{ src_id, dst_id, weight };
-        edge_next++;
+        read_edges([&](uint64_t* vertices, uint64_t count){
+            uint64_t num_found = dense_ids.find(vertices, vertices, count);
+            if(num_found < count) ERROR("The vertex " << vertices[num_found] << " is not present in the vertex list");
+        });
     }
-    m_num_vertices_final = vertex_next; // actual number of vertices read in the final graph
+
     m_num_edges_final = edge_next; // actual number of edges read from the final graph
     cout << "The final graph will contain " << num_final_vertices() << " vertices and " << m_num_edges_final << " edges" << endl;
 
+    if(m_options.m_input_cache){
+        LOG("Saving the parsed graph in the cache: " << InputCache::path(path_input_graph) << " ... ");
+        try {
+            unique_ptr<uint32_t[]> ptr_degrees { new uint32_t[num_final_vertices()] };
+            for(uint64_t i = 0; i < num_final_vertices(); i++){ ptr_degrees[i] = array_frequencies[i].m_frequency; }
+            InputCache::store(path_input_graph, reader.get_path_vertex_list(), reader.get_path_edge_list(), stoull(prop_num_vertices), stoull(prop_num_edges),
+                    m_vertices, ptr_degrees.get(), num_final_vertices(), edges_final, m_num_edges_final);
+        } catch (common::Error& e){ // the cache is only an optimisation, carry on
+            LOG("Warning, cannot save the cache of the input graph: " << e.what());
+        }
+    }
+
+    timer.stop();
+    string compression = reader.get_property("compression");
+    LOG("Input graph parsed in " << timer << ", compression: " << (compression.empty() ? "none" : compression) << ", "
+        "throughput: " << static_cast<uint64_t>(static_cast<double>(m_num_edges_final) / std::max<uint64_t>(1, timer.microseconds()) * 1000000) << " edges/sec");
+}
+
+template<typename WeightPolicy>
+bool Generator<WeightPolicy>::init_load_cache(void* ptr_array_frequencies, std::unique_ptr<EdgeShuffle<edge_t>>& edges_shuffle, const std::string& path_input_graph, double expansion_factor_vertices){
+    LOG("Loading the input graph from the cache: " << InputCache::path(path_input_graph) << " ... ");
+    Timer timer;
+    timer.start();
+    Statistics::Phase phase_stats { "init_load_cache" };
+
+    m_input_cache.reset( new InputCache() );
+    if(!m_input_cache->load<edge_t>(path_input_graph)){
+        LOG("The cache does not exist or it is stale, the input graph will be parsed");
+        phase_stats.add_counter("cache_hit", 0);
+        m_input_cache.reset();
+        return false;
+    }
+    const InputCache& cache = *m_input_cache;
+
+    assert(ptr_array_frequencies != nullptr);
+    auto& array_frequencies = *reinterpret_cast<unique_ptr<InitVertexRecord[]>*>(ptr_array_frequencies);
+
+    m_num_vertices_final = cache.num_vertices_property();
+    m_num_vertices_temporary = ceil( (expansion_factor_vertices - 1.0) * m_num_vertices_final );
+    m_num_vertices_final = cache.num_vertices(); // actual number of vertices read in the final graph
+    if(num_vertices() > std::numeric_limits<uint32_t>::max()) {
+        ERROR("Too many vertices: " << num_vertices() << ", vertices in the final graph: " << num_final_vertices() << ", expansion factor: " << expansion_factor_vertices);
+    }
+    m_num_edges_final = cache.num_edges();
+    if(m_num_edges_final > cache.num_edges_property()) ERROR("The cache contains more edges than stated in the property file: " << cache.num_edges_property());
+    m_edges_final_input = cache.edges<edge_t>();
+    if(m_options.m_edge_order == EdgeOrder::SHUFFLE){
+        edges_shuffle.reset( new EdgeShuffle<edge_t>(cache.num_edges_property(), m_num_final_edges_per_block, m_seed + 57, m_options.m_scratch_directory) );
+    }
+    cout << "The final graph will contain " << num_final_vertices() << " vertices and " << m_num_edges_final << " edges" << endl;
+
+    m_vertices = new uint64_t[num_vertices()];
+    memcpy(m_vertices, cache.vertices(), num_final_vertices() * sizeof(uint64_t));
+    array_frequencies.reset( new InitVertexRecord[num_vertices()] );
+    const uint32_t* __restrict degrees = cache.degrees();
+    for(uint64_t i = 0; i < num_final_vertices(); i++){
+        array_frequencies[i] = InitVertexRecord{ static_cast<uint32_t>(i), degrees[i] };
+    }
+
     timer.stop();
-    LOG("Input graph parsed in " << timer);
+    phase_stats.add_counter("cache_hit", 1);
+    LOG("Input graph loaded from the cache in " << timer);
+    return true;
 }
 
-void Generator::init_temporary_vertices(void* ptr_map_frequencies, void* ptr_array_frequencies, double sf_frequency){
+template<typename WeightPolicy>
+void Generator<WeightPolicy>::init_temporary_vertices(void* ptr_array_frequencies, double sf_frequency){
     LOG("Generating " << num_temporary_vertices() << " (" << 100.0 * num_temporary_vertices() / num_vertices() << " %) non final vertices ... ");
     Timer timer;
     timer.start();
+    Statistics::Phase phase_stats { "init_temporary_vertices" };
 
-    assert(ptr_map_frequencies != nullptr && ptr_array_frequencies != nullptr);
-    auto& map_frequencies = *reinterpret_cast<unordered_map<uint64_t, InitVertexRecord>*>(ptr_map_frequencies);
+    assert(ptr_array_frequencies != nullptr);
     InitVertexRecord* __restrict array_frequencies = reinterpret_cast<InitVertexRecord*>(ptr_array_frequencies);
 
-    { // restrict the scope
-        uint64_t i = 0;
-        for(const auto& it : map_frequencies){
-            assert(m_vertices[it.second.m_offset] == it.first);
-            array_frequencies[i] = it.second;
-            array_frequencies[i].m_frequency *= sf_frequency;
-            i++;
-        }
+    for(uint64_t i = 0; i < num_final_vertices(); i++){
+        assert(array_frequencies[i].m_offset == i);
+        array_frequencies[i].m_frequency *= sf_frequency;
     }
 
     if(num_temporary_vertices() > 0){
-        std::sort(array_frequencies, array_frequencies + num_final_vertices(), [](const InitVertexRecord& v1, const InitVertexRecord& v2){
-           return v1.m_frequency > v2.m_frequency;
+        // the IDs of the final vertices in sorted order, to generate IDs for the temporary vertices that do not clash
+        unique_ptr<uint64_t[]> ptr_final_ids { new uint64_t[num_final_vertices()] };
+        uint64_t* __restrict final_ids = ptr_final_ids.get();
+        memcpy(final_ids, m_vertices, num_final_vertices() * sizeof(uint64_t));
+        parallel_sort(m_options.m_init_threads, final_ids, final_ids + num_final_vertices());
+        uint64_t final_ids_pos = 0;
+
+        // by decreasing frequency, ties are broken by the vertex offset so that the order does not depend on the
+        // number of threads used to sort
+        parallel_sort(m_options.m_init_threads, array_frequencies, array_frequencies + num_final_vertices(), [](const InitVertexRecord& v1, const InitVertexRecord& v2){
+           return v1.m_frequency > v2.m_frequency || (v1.m_frequency == v2.m_frequency && v1.m_offset < v2.m_offset);
         });
 
         uint64_t external_vertex_id = 1;
@@ -205,7 +402,10 @@ void Generator::init_temporary_vertices(void* ptr_map_frequencies, void* ptr_arr
                 remaining_free_spots--;
 
                 // generate the ID of the vertex to insert
-                while(map_frequencies.count(external_vertex_id) > 0){ external_vertex_id ++ ; }
+                while(final_ids_pos < num_final_vertices() && final_ids[final_ids_pos] <= external_vertex_id){
+                    if(final_ids[final_ids_pos] == external_vertex_id){ external_vertex_id++; }
+                    final_ids_pos++;
+                }
                 m_vertices[offset_vertex_id] = external_vertex_id;
 //                COUT_DEBUG("Temporary vertex: " << external_vertex_id << " [internal id: " << offset_vertex_id << "], frequency: " << vertex_freq);
 
@@ -226,62 +426,128 @@ void Generator::init_temporary_vertices(void* ptr_map_frequencies, void* ptr_arr
     LOG("Vertices generated in " << timer);
 }
 
-void Generator::init_counting_tree(void* ptr_array_frequencies){
+template<typename WeightPolicy>
+void Generator<WeightPolicy>::init_counting_tree(void* ptr_array_frequencies){
     LOG("Initialising the counting tree for " << num_vertices() << " vertices ... ");
     Timer timer;
     timer.start();
+    Statistics::Phase phase_stats { "init_counting_tree" };
 
     assert(ptr_array_frequencies != nullptr);
     InitVertexRecord* __restrict array_frequencies = reinterpret_cast<InitVertexRecord*>(ptr_array_frequencies);
 
-    m_frequencies = new CountingTree(num_vertices());
+    // the frequencies indexed by the vertex offset, as the leaves of the tree
+    unique_ptr<CountingTree::value_t[]> ptr_values { new CountingTree::value_t[num_vertices()]() };
+    CountingTree::value_t* __restrict values = ptr_values.get();
     for(uint64_t i = 0, sz = num_vertices(); i < sz ; i++){
-        m_frequencies->set(array_frequencies[i].m_offset, array_frequencies[i].m_frequency);
+        values[array_frequencies[i].m_offset] = array_frequencies[i].m_frequency;
     }
 
+    m_frequencies = new CountingTree(num_vertices());
+    m_frequencies->bulk_load(values, m_options.m_init_threads);
+
 //    m_frequencies->dump();
 
     timer.stop();
     LOG("Counting tree created in " << timer);
 }
 
-void Generator::init_permute_edges_final(std::unique_ptr<WeightedEdge[]>& ptr_edges_final){
-    LOG("Permuting the edges in the final graph ... ");
+template<typename WeightPolicy>
+void Generator<WeightPolicy>::init_alias_table(void* ptr_array_frequencies){
+    LOG("Initialising the alias table for " << num_vertices() << " vertices ... ");
     Timer timer;
     timer.start();
+    Statistics::Phase phase_stats { "init_alias_table" };
+
+    assert(ptr_array_frequencies != nullptr);
+    InitVertexRecord* __restrict array_frequencies = reinterpret_cast<InitVertexRecord*>(ptr_array_frequencies);
 
-    unique_ptr<uint64_t[]> ptr_permutation { new uint64_t[m_num_edges_final] };
-    uint64_t* permutation = ptr_permutation.get();
-    for(uint64_t i = 0; i < m_num_edges_final; i++){
-        permutation[i] = i;
+    // the frequencies indexed by the vertex offset
+    unique_ptr<int64_t[]> ptr_values { new int64_t[num_vertices()]() };
+    int64_t* __restrict values = ptr_values.get();
+    for(uint64_t i = 0, sz = num_vertices(); i < sz ; i++){
+        values[array_frequencies[i].m_offset] = array_frequencies[i].m_frequency;
     }
-    common::permute(permutation, m_num_edges_final, m_seed + 57);
 
-    WeightedEdge* edges = ptr_edges_final.get();
+    m_frequencies_alias.reset( new AliasTable(values, num_vertices()) );
+
+    timer.stop();
+    LOG("Alias table created in " << timer);
+}
+
+template<typename WeightPolicy>
+void Generator<WeightPolicy>::init_degree_buckets(void* ptr_array_frequencies){
+    LOG("Grouping " << num_vertices() << " vertices by frequency ... ");
+    Timer timer;
+    timer.start();
+    Statistics::Phase phase_stats { "init_degree_buckets" };
+
+    assert(ptr_array_frequencies != nullptr);
+    InitVertexRecord* __restrict array_frequencies = reinterpret_cast<InitVertexRecord*>(ptr_array_frequencies);
+
+    // the frequencies indexed by the vertex offset
+    unique_ptr<int64_t[]> ptr_values { new int64_t[num_vertices()]() };
+    int64_t* __restrict values = ptr_values.get();
+    for(uint64_t i = 0, sz = num_vertices(); i < sz ; i++){
+        values[array_frequencies[i].m_offset] = array_frequencies[i].m_frequency;
+    }
 
-    uint64_t num_blocks = num_blocks_in_final_edges();
-    m_edges_final = (WeightedEdge**) calloc(num_blocks, sizeof(WeightedEdge*));
-    if(m_edges_final == nullptr) throw bad_alloc();
+    m_frequencies_buckets.reset( new DegreeBuckets(values, num_vertices()) );
+    phase_stats.add_counter("buckets", m_frequencies_buckets->num_buckets());
 
-    for(uint64_t i = 0; i < num_blocks; i++){
-        bool last_block = (i == num_blocks -1);
-        uint64_t num_edges_in_block = last_block ? m_num_edges_final - i * m_num_final_edges_per_block : m_num_final_edges_per_block;
-        m_edges_final[i] = (WeightedEdge*) malloc(num_edges_in_block * sizeof(WeightedEdge));
-        if(m_edges_final[i] == nullptr) throw bad_alloc();
+    timer.stop();
+    LOG("Vertices grouped in " << m_frequencies_buckets->num_buckets() << " buckets in " << timer << ", "
+        "footprint: " << m_frequencies_buckets->footprint() / 1024 / 1024 << " MB");
+}
 
-        for(uint64_t j = 0; j < num_edges_in_block; j++){
-            m_edges_final[i][j] = edges[permutation[i * m_num_final_edges_per_block + j]];
+template<typename WeightPolicy>
+void Generator<WeightPolicy>::init_permute_edges_final(EdgeShuffle<edge_t>& edges_shuffle, const edge_t* edges){
+    LOG("Permuting the edges in the final graph ... ");
+    Timer timer;
+    timer.start();
+    Statistics::Phase phase_stats { "init_permute_edges_final" };
+
+    // the edges not yet scattered while reading the input graph
+    if(edges != nullptr){
+        constexpr uint64_t chunk_capacity = (1ull << 20);
+        unique_ptr<edge_t*[]> ptr_positions { new edge_t*[std::min(chunk_capacity, m_num_edges_final)] };
+        edge_t** __restrict positions = ptr_positions.get();
+        for(uint64_t chunk_start = 0; chunk_start < m_num_edges_final; chunk_start += chunk_capacity){
+            uint64_t chunk_sz = std::min(chunk_capacity, m_num_edges_final - chunk_start);
+            edges_shuffle.reserve(chunk_sz, positions, m_options.m_init_threads);
+            parallel_for(m_options.m_init_threads, chunk_sz, [&](uint64_t start, uint64_t end){
+                for(uint64_t i = start; i < end; i++){ *(positions[i]) = edges[chunk_start + i]; }
+            });
         }
     }
+    assert(edges_shuffle.num_edges() == m_num_edges_final);
+
+    edges_shuffle.shuffle(m_options.m_init_threads);
+    if(edges_shuffle.is_external()){
+        m_edges_final_scratch.reset( new ScratchBlockReader<edge_t>(edges_shuffle.release_file(), m_num_final_edges_per_block) );
+    } else {
+        m_edges_final = edges_shuffle.release();
+    }
 
     timer.stop();
     LOG("Permutation completed in " << timer);
 }
 
-void Generator::init_writer(const string& path_output){
+template<typename WeightPolicy>
+void Generator<WeightPolicy>::init_order_edges_final(){
+    assert(m_edges_final_input != nullptr || m_num_edges_final == 0);
+    // the edges are not copied, only the keys of the bijection are generated
+    Statistics::Phase phase_stats { "init_order_edges_final" };
+    m_edges_final_order.reset( new FeistelPermutation(m_num_edges_final, m_seed + 57) );
+    LOG("The final edges will be visited through a Feistel network, without permuting them");
+}
+
+template<typename WeightPolicy>
+void Generator<WeightPolicy>::init_writer(const string& path_output){
     LOG("Initialising the log file ....");
     Timer timer;
     timer.start();
+    Statistics::Phase phase_stats { "init_writer" };
 
     // We cannot guarantee to generate exactly `m_num_operations', as we could need to fill some deletions at the end
     // We will store the actual number of operations (edges) generated at the end
@@ -305,7 +571,8 @@ void Generator::init_writer(const string& path_output){
  *                                                                           *
  *****************************************************************************/
 
-uint64_t Generator::num_blocks_in_final_edges() const {
+template<typename WeightPolicy>
+uint64_t Generator<WeightPolicy>::num_blocks_in_final_edges() const {
     return (m_num_edges_final / m_num_final_edges_per_block) + (m_num_edges_final % m_num_final_edges_per_block != 0);
 }
 
@@ -314,22 +581,37 @@ uint64_t Generator::num_blocks_in_final_edges() const {
  *  Generate the operations                                                  *
  *                                                                           *
  *****************************************************************************/
-uint64_t Generator::generate0() {
+template<typename WeightPolicy>
+template<typename TemporaryEdges, typename VertexSampler>
+uint64_t Generator<WeightPolicy>::generate0(VertexSampler& vertex_sampler) {
     cout << "Generating " << m_num_operations << " operations ..." << endl;
     Timer timer;
     timer.start();
+    Statistics::Phase phase_stats { "generate" };
 
-    ABTree<uint64_t, Edge> temporary_edges; // edges that need to be removed before the end of the generation process
-    unordered_map<Edge, uint64_t> edges_stored; // edges currently stored in the graph
+    const uint64_t edges_stored_capacity = std::max(m_num_max_edges, m_num_edges_final +1);
+    EdgeMap edges_stored { edges_stored_capacity }; // edges currently stored in the graph, with their key in `temporary_edges', or 0 for the final edges
+    TemporaryEdges temporary_edges { edges_stored, m_random, edges_stored_capacity }; // edges that need to be removed before the end of the generation process
     OutputBuffer output{m_writer}; // output buffer
 //    uniform_real_distribution<double> unif_real{0., 1.}; // uniform distribution in [0, 1]
-    uniform_int_distribution<uint64_t> unif_uint64_t{1, numeric_limits<uint64_t>::max()};
-    uniform_int_distribution<uint64_t> unif_frequencies{0, (uint64_t) m_frequencies->total_count() - 1};
 
     int last_progress_reported = 0;
     int64_t edges_final_block = -1, edges_final_offset = 0, edges_final_block_sz = 0, edges_final_position = 0;
+    const edge_t* edges_final_current = nullptr; // the block of final edges being inserted
+    constexpr uint64_t num_edges_final_prefetched = 16; // with --edge-order feistel, how many final edges to prefetch ahead
+    uint64_t edges_final_prefetched[num_edges_final_prefetched]; // with --edge-order feistel, the positions of the next final edges
+    if(m_edges_final_order){
+        for(uint64_t i = 0, end = std::min(num_edges_final_prefetched, m_num_edges_final); i < end; i++){
+            edges_final_prefetched[i] = (*m_edges_final_order)(i);
+            __builtin_prefetch(m_edges_final_input + edges_final_prefetched[i], /* read */ 0, /* no temporal locality */ 0);
+        }
+    }
 //    double prob_bump = 1.0; // heuristics to bump up the probability of inserting a final edge
     uint64_t num_ops_performed = 0;
+    uint64_t num_insertions_final = 0; // statistics, number of final edges inserted
+    uint64_t num_insertions_temporary = 0; // statistics, number of temporary edges inserted
+    uint64_t num_deletions = 0; // statistics, number of temporary edges removed
+    uint64_t num_sampling_retries = 0; // statistics, number of temporary edges sampled that were already in the graph
 
     while (num_ops_performed < m_num_operations || /* there are still edges to delete */ !temporary_edges.empty()) {
         assert(edges_final_position <= m_num_edges_final);
@@ -342,7 +624,7 @@ uint64_t Generator::generate0() {
                      "edges final: " << edges_final_position << "/" << m_num_edges_final << " (" << 100.0 * edges_final_position / m_num_edges_final << " %), "
                      "edges temp: " << temporary_edges.size() << "/" << edges_stored.size() << " (" << 100.0 * temporary_edges.size() / edges_stored.size() << " %), "
                      "ht size: " << edges_stored.size() << " (ff: " << 100.0 * edges_stored.load_factor() << " %), "
-                     "abtree footprint: " << temporary_edges.memory_footprint() / 1024 / 1024 << " MB, "
+                     "temporary edges footprint: " << temporary_edges.memory_footprint() / 1024 / 1024 << " MB, "
                      "elapsed time: " << timer
              );
         }
@@ -356,109 +638,86 @@ uint64_t Generator::generate0() {
             if ((num_missing_final_edges > 0 && (num_ops_performed + num_missing_final_edges + temporary_edges.size() >= m_num_operations)) ||
                 (edges_final_position < (static_cast<double>(num_ops_performed) / m_num_operations) * m_num_edges_final) ){
 
-                // retrieve the next block of final edges
-                if (edges_final_offset >= edges_final_block_sz) {
-                    if (edges_final_block >= 0) {
-                        COUT_DEBUG("Deallocating a block of final edges " << edges_final_block << "/" << num_blocks_in_final_edges() << " ...");
-                        free(m_edges_final[edges_final_block]);
-                        m_edges_final[edges_final_block] = nullptr;
+                edge_t edge_final;
+                if (m_edges_final_order) { // fetch the next final edge through the bijection
+                    uint64_t& position = edges_final_prefetched[edges_final_position % num_edges_final_prefetched];
+                    edge_final = m_edges_final_input[position];
+                    if (edges_final_position + num_edges_final_prefetched < m_num_edges_final) {
+                        position = (*m_edges_final_order)(edges_final_position + num_edges_final_prefetched);
+                        __builtin_prefetch(m_edges_final_input + position, /* read */ 0, /* no temporal locality */ 0);
+                    }
+                } else {
+                    // retrieve the next block of final edges
+                    if (edges_final_offset >= edges_final_block_sz) {
+                        if (edges_final_block >= 0 && m_edges_final != nullptr) {
+                            COUT_DEBUG("Deallocating a block of final edges " << edges_final_block << "/" << num_blocks_in_final_edges() << " ...");
+                            free(m_edges_final[edges_final_block]);
+                            m_edges_final[edges_final_block] = nullptr;
+                        }
+
+                        edges_final_block++;
+                        bool last_block = (edges_final_block == num_blocks_in_final_edges() - 1);
+                        edges_final_block_sz = (last_block ? m_num_edges_final - edges_final_block * m_num_final_edges_per_block : m_num_final_edges_per_block);
+                        edges_final_offset = 0;
+                        edges_final_current = m_edges_final_scratch ? m_edges_final_scratch->next() : m_edges_final[edges_final_block];
                     }
 
-                    edges_final_block++;
-                    bool last_block = (edges_final_block == num_blocks_in_final_edges() - 1);
-                    edges_final_block_sz = (last_block ? m_num_edges_final - edges_final_block * m_num_final_edges_per_block : m_num_final_edges_per_block);
-                    edges_final_offset = 0;
+                    edge_final = edges_final_current[edges_final_offset];
+                    edges_final_offset++;
                 }
 
                 // insert a final edge
-                WeightedEdge edge_final = m_edges_final[edges_final_block][edges_final_offset];
                 edges_final_position++;
-                edges_final_offset++;
 
                 // if we previously inserted this edge as a temporary edge, remove it first
-                auto it = edges_stored.find(edge_final.edge());
-                if (it != edges_stored.end()) {
-                    assert(it->second > 0 && "0 is reserved for the final edges. If it's already present, then the loaded graph has duplicate edges");
-                    // The (a,b)-tree may contain multiple edges with the same key (duplicates). In case we removed the
-                    // wrong edge, reinsert it with a new key
-                    Edge edge_removed;
-                    while (temporary_edges.remove(it->second, &edge_removed) && edge_removed != edge_final.edge()) {
-                        uint64_t new_key = unif_uint64_t(m_random);
-                        temporary_edges.insert(new_key, edge_removed);
-                        edges_stored[edge_removed] = new_key;
-                    };
-                    assert(edge_removed == edge_final.edge() && "Cannot find the previous temporary edge");
+                uint64_t edge_key;
+                if (edges_stored.find(edge_final.edge(), &edge_key)) {
+                    assert(edge_key > 0 && "0 is reserved for the final edges. If it's already present, then the loaded graph has duplicate edges");
+                    temporary_edges.remove(edge_final.edge(), edge_key);
 
                     // emit a deletion
                     output.emit(m_vertices[ edge_final.source() ], m_vertices[ edge_final.destination() ], -1);
                     num_ops_performed++;
+                    num_deletions++;
 
                 };
 
-                output.emit(m_vertices[ edge_final.source() ], m_vertices[ edge_final.destination() ], edge_final.weight());
-                edges_stored[edge_final.edge()] = 0;
+                output.emit(m_vertices[ edge_final.source() ], m_vertices[ edge_final.destination() ], WeightPolicy::weight(edge_final));
+                edges_stored.insert(edge_final.edge(), 0);
+                num_insertions_final++;
             } else { // insert a temporary edge
                 // generate a random edge
                 Edge edge_temporary;
+                uint64_t num_attempts = 0;
                 do {
+                    num_attempts++;
+
                     // generate the source_id
-                    uint32_t src_id = m_frequencies->search(unif_frequencies(m_random));
-                    int64_t old_frequency;
-                    m_frequencies->unset(src_id, &old_frequency);
+                    uint32_t src_id = vertex_sampler.sample(m_random);
 
                     // generate the destination_id
-                    uniform_int_distribution<uint64_t> unif_tmp{0, (uint64_t) m_frequencies->total_count() - 1};
-                    uint32_t dst_id = m_frequencies->search(unif_tmp(m_random));
+                    uint32_t dst_id = vertex_sampler.sample_excluding(src_id, m_random);
                     assert(src_id != dst_id);
 
-                    // reset the frequency for the source_id
-                    m_frequencies->set(src_id, old_frequency);
-
                     // check whether this edge is already contained in the graph
                     if (dst_id < src_id) std::swap(src_id, dst_id);
                     edge_temporary.m_source = src_id;
                     edge_temporary.m_destination = dst_id;
-                } while (edges_stored.count(edge_temporary) > 0); // and repeat...
+                } while (edges_stored.contains(edge_temporary)); // and repeat...
+                num_sampling_retries += num_attempts -1;
 
-                uint64_t edge_key = unif_uint64_t(m_random);
-                assert(edge_key != 0 && "0 is reserved for the edges of the final graph");
-                edges_stored[edge_temporary] = edge_key;
-                temporary_edges.insert(edge_key, edge_temporary);
+                temporary_edges.insert(edge_temporary);
                 output.emit(m_vertices[ edge_temporary.source() ], m_vertices[ edge_temporary.destination() ], 0.0);
+                num_insertions_temporary++;
 
 //                COUT_DEBUG("INSERT_TEMP " << edge_temporary.source() << " -> " << edge_temporary.destination());
             };
 
         } else { // remove a temporary edge
-            assert(!temporary_edges.empty() && "There are no temporary edges to remove");
-            uint64_t random_key = unif_uint64_t(m_random);
-
-            uint64_t edge_key;
-            Edge edge_temporary;
-            { // restrict the scope
-                auto it = temporary_edges.iterator(random_key, std::numeric_limits<uint64_t>::max());
-                if (it->has_next()) {
-                    it->next(&edge_key, &edge_temporary);
-                } else {
-                    edge_key = temporary_edges.key_min();
-                    assert(edge_key != 0 && "The value 0 is reserved for final edges");
-                    temporary_edges.find(edge_key, &edge_temporary);
-                }
-            }
-            assert(edges_stored.count(edge_temporary) > 0 && "Edge not present in the graph");
-            assert(edges_stored[edge_temporary] == edge_key && "Key mismatch");
-
-            // The (a,b)-tree may contain multiple edges with the same key (duplicates). In case we removed the
-            // wrong edge, reinsert it with a new key
-            Edge edge_removed;
-            while (temporary_edges.remove(edge_key, &edge_removed) && edge_removed != edge_temporary) {
-                uint64_t new_key = unif_uint64_t(m_random);
-                temporary_edges.insert(new_key, edge_removed);
-                edges_stored[edge_removed] = new_key;
-            };
-
-            edges_stored.erase(edge_temporary);
+            Edge edge_temporary = temporary_edges.remove_random();
+            edges_stored.remove(edge_temporary);
             output.emit(m_vertices[ edge_temporary.source() ], m_vertices[ edge_temporary.destination() ], -1.0);
+            num_deletions++;
         };
 
         num_ops_performed++;
@@ -472,12 +731,43 @@ uint64_t Generator::generate0() {
     assert(num_ops_performed >= m_num_operations && "Generated less operations than what requested");
 
     timer.stop();
+    phase_stats.add_counter("operations", num_ops_performed);
+    phase_stats.add_counter("insertions_final", num_insertions_final);
+    phase_stats.add_counter("insertions_temporary", num_insertions_temporary);
+    phase_stats.add_counter("deletions", num_deletions);
+    phase_stats.add_counter("sampling_retries", num_sampling_retries);
+    phase_stats.add_counter("abtree_reinsertions", temporary_edges.num_reinsertions());
     LOG("Operations generated in " << timer << ". Writing the final edges in the log file ... ");
 
     return num_ops_performed;
 }
 
-void Generator::generate(){
-    uint64_t num_ops_performed = generate0(); // wait for the output buffer to complete...
+template<typename WeightPolicy>
+void Generator<WeightPolicy>::generate(){
+    auto run = [this](auto& vertex_sampler){
+        switch(m_options.m_temporary_edges){
+        case TemporaryEdgesStore::ABTREE:
+            return generate0<TemporaryEdgesABTree>(vertex_sampler); // wait for the output buffer to complete...
+        case TemporaryEdgesStore::VECTOR:
+        default:
+            return generate0<TemporaryEdgesVector>(vertex_sampler);
+        }
+    };
+
+    uint64_t num_ops_performed = 0;
+    if(m_frequencies_alias){
+        AliasTableSampler vertex_sampler { *m_frequencies_alias };
+        num_ops_performed = run(vertex_sampler);
+    } else if(m_frequencies_buckets){
+        DegreeBucketSampler vertex_sampler { *m_frequencies_buckets };
+        num_ops_performed = run(vertex_sampler);
+    } else {
+        CountingTreeSampler vertex_sampler { *m_frequencies };
+        num_ops_performed = run(vertex_sampler);
+    }
     m_writer.write_num_edges(num_ops_performed);
-}
\ No newline at end of file
+}
+
+// explicit instantiations
+template class Generator<EdgeWeighted>;
+template class Generator<EdgeUnweighted>;
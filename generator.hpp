@@ -26,11 +26,61 @@
 #include "abtree.hpp"
 #include "counting_tree.hpp"
 #include "edge.hpp"
-
+#include "graphalytics_reader.hpp"
+
+class AliasTable; // forward decl.
+class DegreeBuckets; // forward decl.
+template<typename E> class EdgeShuffle; // forward decl.
+class FeistelPermutation; // forward decl.
+class InputCache; // forward decl.
+template<typename E> class ScratchBlockReader; // forward decl.
 class Writer; // forward decl.
 
+// How to randomise the order the final edges are inserted
+enum class EdgeOrder {
+    SHUFFLE, // permute the final edges while they are loaded, through an EdgeShuffle
+    FEISTEL // visit the final edges in the order of the input graph through a keyed bijection, without copying them
+};
+
+// How to store the temporary edges during the generation
+enum class TemporaryEdgesStore {
+    VECTOR, // TemporaryEdgesVector, a dense array with swap-remove
+    ABTREE // TemporaryEdgesABTree, indexed by a random key in an (a,b)-tree
+};
+
+// How to draw the endpoints of the temporary edges
+enum class VertexSamplerType {
+    ALIAS, // AliasTableSampler
+    DEGREE_BUCKETS, // DegreeBucketSampler
+    COUNTING_TREE // CountingTreeSampler
+};
+
+/**
+ * The settings of the generator that select its data structures and the resources used by the initialisation. They
+ * are parsed from the command line in main.cpp.
+ */
+struct GeneratorOptions {
+    // Number of threads for the parallel steps of the initialisation: parse or decompress the input graph, sort the
+    // vertices, build the counting tree and shuffle the final edges. The generation of the operations is sequential.
+    uint64_t m_init_threads = 1;
+    uint64_t m_reader_buffer_size = GraphalyticsReader::default_buffer_size(); // size of the chunks read ahead from the compressed input files, in bytes
+    bool m_input_cache = false; // whether to load/store the parsed input graph from/to a binary cache next to its property file
+    EdgeOrder m_edge_order = EdgeOrder::SHUFFLE; // how to randomise the order of the final edges
+    std::string m_scratch_directory; // if not empty, keep the final edges in scratch files in this directory rather than in memory
+    TemporaryEdgesStore m_temporary_edges = TemporaryEdgesStore::VECTOR; // how to store the temporary edges
+    VertexSamplerType m_vertex_sampler = VertexSamplerType::ALIAS; // how to draw the endpoints of the temporary edges
+};
+
+/**
+ * The generator is specialised on a weight policy, either EdgeWeighted or EdgeUnweighted, chosen according to
+ * whether the input graph is weighted
+ */
+template<typename WeightPolicy>
 class Generator {
+    using edge_t = typename WeightPolicy::edge_t; // the layout of the final edges
+
     Writer& m_writer; // serialise the operations in the log file
+    const GeneratorOptions m_options; // the data structures to use and the threads for the initialisation
 
     uint64_t m_num_operations; // total number of operations (insertions/deletions of edges) to create
     uint64_t m_num_max_edges; // max number of edges that can be stored in the graph
@@ -40,27 +90,40 @@ class Generator {
     uint64_t m_num_vertices_final = 0; // num vertices that actually belong to the final graph
     uint64_t m_num_vertices_temporary = 0; // num vertices that are temporary, it will need to be removed from the final graphs
     static constexpr uint64_t m_num_final_edges_per_block = (1ull << 23); // number of `final' edges per block, 8M
-    WeightedEdge** m_edges_final = nullptr; // list of vertices that belong to the final graph
+    edge_t** m_edges_final = nullptr; // list of vertices that belong to the final graph
+    std::unique_ptr<ScratchBlockReader<edge_t>> m_edges_final_scratch; // with --scratch-dir, the blocks of final edges streamed back from the scratch directory
+    std::unique_ptr<FeistelPermutation> m_edges_final_order; // with --edge-order feistel, the order to visit `m_edges_final_input'
+    const edge_t* m_edges_final_input = nullptr; // with --edge-order feistel, the final edges in the same order of the input graph
+    std::unique_ptr<edge_t[]> m_edges_final_input_array; // owner of the final edges parsed from the input graph, if any
+    std::unique_ptr<InputCache> m_input_cache; // owner of the final edges loaded from the cache, if any
     uint64_t m_num_edges_final = 0; // total number of edges
     CountingTree* m_frequencies = nullptr; // the frequency  associated to each vertex in the graph. Initially the frequency is the number of edges attached in the loaded graph.
+    std::unique_ptr<AliasTable> m_frequencies_alias; // with --vertex-sampler alias, the frequencies in a static alias table, rather than in `m_frequencies'
+    std::unique_ptr<DegreeBuckets> m_frequencies_buckets; // with --vertex-sampler degree-buckets, the vertices grouped by frequency, rather than in `m_frequencies'
     std::unordered_map<Edge, bool> m_edges_present; // edges present during the creation of the graph
     std::mt19937_64 m_random;
 
-    void init_read_input_graph(void* ptr_edges_final, void* ptr_frequencies, const std::string& path_input_graph, double ef_vertices);
-    void init_temporary_vertices(void* ptr_map_frequencies, void* ptr_array_frequencies, double sf_frequency);
+    void init_read_input_graph(void* ptr_array_frequencies, std::unique_ptr<EdgeShuffle<edge_t>>& edges_shuffle, const std::string& path_input_graph, double ef_vertices);
+    bool init_load_cache(void* ptr_array_frequencies, std::unique_ptr<EdgeShuffle<edge_t>>& edges_shuffle, const std::string& path_input_graph, double ef_vertices);
+    void init_temporary_vertices(void* ptr_array_frequencies, double sf_frequency);
     void init_counting_tree(void* ptr_array_frequencies);
-    void init_permute_edges_final(std::unique_ptr<WeightedEdge[]>& ptr_edges_final);
+    void init_alias_table(void* ptr_array_frequencies);
+    void init_degree_buckets(void* ptr_array_frequencies);
+    void init_permute_edges_final(EdgeShuffle<edge_t>& edges_shuffle, const edge_t* edges);
+    void init_order_edges_final();
     void init_writer(const std::string& path_log_file);
 
     // total number of blocks in the final edges
     uint64_t num_blocks_in_final_edges() const;
 
-    // Actual generator, return the number of operations performed
-    uint64_t generate0();
+    // Actual generator, return the number of operations performed. The temporary edges are kept in either
+    // TemporaryEdgesVector or TemporaryEdgesABTree, their endpoints are drawn through the given VertexSampler
+    template<typename TemporaryEdges, typename VertexSampler>
+    uint64_t generate0(VertexSampler& vertex_sampler);
 
 public:
     // Constructor
-    Generator(const std::string& path_input_graph, const std::string& path_output_log, Writer& writer, double sf_frequencies, double ef_vertices, double ef_edges, double aging_factor, uint64_t seed);
+    Generator(const std::string& path_input_graph, const std::string& path_output_log, Writer& writer, const GeneratorOptions& options, double sf_frequencies, double ef_vertices, double ef_edges, double aging_factor, uint64_t seed);
 
     // Destructor
     ~Generator();
@@ -79,4 +142,7 @@ public:
 
     // Total number of vertices generated
     uint64_t num_vertices() const { return num_final_vertices() + num_temporary_vertices(); }
+
+    // Number of final edges in each block
+    static constexpr uint64_t num_final_edges_per_block() { return m_num_final_edges_per_block; }
 };
\ No newline at end of file
@@ -17,13 +17,35 @@
 
 #include "graphalytics_reader.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <cerrno>
+#include <condition_variable>
 #include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <regex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
 #include <zlib.h>
+#if defined(HAVE_ZSTD)
+#include <zstd.h>
+#endif
+#if defined(HAVE_LZ4)
+#include <lz4frame.h>
+#endif
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 #include "lib/common/filesystem.hpp"
 
 using namespace std;
@@ -65,6 +87,367 @@ static bool is_number(const char* marker){
     return marker != nullptr && (marker[0] >= '0' && marker[0] <= '9');
 }
 
+// Check whether the given file can be memory mapped, that is, it is a regular file
+static bool is_regular_file(const string& path){
+    struct stat info;
+    return ::stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+// Check whether the given character is a white space inside a line, that is, any white space but the new line
+static inline bool is_blank(char c){
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Check whether the given character is a digit
+static inline bool is_digit(char c){
+    return c >= '0' && c <= '9';
+}
+
+// Check whether the given character terminates a field, in the same way strtoull/strtod stop at white spaces or at the end of a C string
+static inline bool is_field_end(const char* current, const char* end){
+    return current >= end || isspace(current[0]) || current[0] == '\0';
+}
+
+// Parse an unsigned integer starting at `current'. The caller must ensure that current points to a digit.
+// On overflow, the result saturates to UINT64_MAX as strtoull would do.
+static inline uint64_t scan_uint64(const char*& current, const char* end){
+    uint64_t result = 0;
+    bool overflow = false;
+    while(current < end && is_digit(current[0])){
+        overflow |= __builtin_mul_overflow(result, 10, &result);
+        overflow |= __builtin_add_overflow(result, static_cast<uint64_t>(current[0] - '0'), &result);
+        current++;
+    }
+    return overflow ? numeric_limits<uint64_t>::max() : result;
+}
+
+// Parse a floating point number starting at `current'. The caller must ensure that current points to a digit.
+// Numbers of the form <digits>[.<digits>][e[+-]<digits>] that can be represented exactly by the mantissa of a double and
+// a power of 10 up to 10^22 are converted directly (Clinger's fast path), as the result is guaranteed to be
+// the same of strtod. Everything else is delegated to strtod.
+static double scan_double(const char*& current, const char* end){
+    static constexpr double powers_of_ten[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+            1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    const char* start = current;
+    uint64_t mantissa = 0;
+    int num_digits = 0; // significant digits stored in the mantissa
+    int64_t exponent = 0;
+    bool fast_path = true;
+
+    // integral part
+    while(current < end && is_digit(current[0])){
+        if(mantissa > 0 || current[0] != '0'){
+            if(num_digits < 19){ mantissa = mantissa * 10 + (current[0] - '0'); } else { fast_path = false; }
+            num_digits++;
+        }
+        current++;
+    }
+
+    // fractional part
+    if(current < end && current[0] == '.'){
+        current++;
+        while(current < end && is_digit(current[0])){
+            if(mantissa > 0 || current[0] != '0'){
+                if(num_digits < 19){ mantissa = mantissa * 10 + (current[0] - '0'); } else { fast_path = false; }
+                num_digits++;
+            }
+            exponent--;
+            current++;
+        }
+    }
+
+    // exponent
+    if(current < end && (current[0] == 'e' || current[0] == 'E')){
+        const char* marker = current +1;
+        bool negative = false;
+        if(marker < end && (marker[0] == '+' || marker[0] == '-')){
+            negative = marker[0] == '-';
+            marker++;
+        }
+        if(marker < end && is_digit(marker[0])){
+            int64_t value = 0;
+            while(marker < end && is_digit(marker[0])){
+                if(value < 100000){ value = value * 10 + (marker[0] - '0'); }
+                marker++;
+            }
+            exponent += negative ? -value : value;
+            current = marker;
+        } // else strtod would not consume the `e', the following check will route us to the slow path
+    }
+
+    if(fast_path && is_field_end(current, end) && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22){
+        double value = static_cast<double>(mantissa);
+        return exponent < 0 ? value / powers_of_ten[-exponent] : value * powers_of_ten[exponent];
+    }
+
+    // slow path, copy the token in a null terminated buffer and rely on strtod
+    current = start;
+    while(!is_field_end(current, end)) current++;
+    string token(start, current);
+    return strtod(token.c_str(), nullptr);
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Tokenizer for the plain text format                                      *
+ *                                                                           *
+ *****************************************************************************/
+
+// Move the cursor after the end of the current line
+static void skip_line(const char*& cursor, const char* end){
+    const char* eol = reinterpret_cast<const char*>(memchr(cursor, '\n', end - cursor));
+    cursor = (eol == nullptr) ? end : eol +1;
+}
+
+// Move the cursor to the start of the next line that is not a comment or empty. Return false if the end of the text has been reached.
+static bool next_line(const char*& cursor, const char* end){
+    while(cursor < end){
+        while(cursor < end && isspace(cursor[0])) cursor++; // white spaces & empty lines
+        if(cursor >= end) return false;
+        if(cursor[0] != '#' && cursor[0] != '\0') return true; // ignore_line() considers '\0' as the end of the line
+        skip_line(cursor, end);
+    }
+    return false;
+}
+
+// Skip the white spaces in the current line
+static void skip_blanks(const char*& cursor, const char* end){
+    while(cursor < end && is_blank(cursor[0])) cursor++;
+}
+
+// Retrieve the line starting at the given position, to report an error
+static string get_line(const char* start, const char* end){
+    const char* eol = reinterpret_cast<const char*>(memchr(start, '\n', end - start));
+    return string(start, eol == nullptr ? end : eol);
+}
+
+// Parse the next edge in the given text. Return false if there are no more edges to read.
+static bool parse_edge(const char*& cursor, const char* end, bool is_weighted, uint64_t& source, uint64_t& destination, double& weight){
+    if(!next_line(cursor, end)) return false;
+    const char* line = cursor;
+
+    // read the source
+    if(!is_digit(cursor[0])) ERROR("line: `" << get_line(line, end) << "', cannot read the source vertex");
+    source = scan_uint64(cursor, end);
+
+    skip_blanks(cursor, end);
+    if(cursor >= end || !is_digit(cursor[0])) ERROR("line: `" << get_line(line, end) << "', cannot read the destination vertex");
+    destination = scan_uint64(cursor, end);
+
+    if(is_weighted){
+        skip_blanks(cursor, end);
+        if(cursor >= end || !is_digit(cursor[0])) ERROR("line: `" << get_line(line, end) << "', cannot read the weight");
+        weight = scan_double(cursor, end);
+    } else {
+        weight = 0;
+    }
+
+    skip_line(cursor, end);
+    return true;
+}
+
+// Signature of the functions to parse a batch of edges from the text [cursor, end). The cursor must point to the start
+// of a line and it is moved after the last edge parsed. The weights are only set for weighted graphs, otherwise the
+// array can be a nullptr. Return the number of edges parsed.
+using parse_edges_t = uint64_t (*)(const char*& cursor, const char* end, bool is_weighted, uint64_t* sources, uint64_t* destinations, double* weights, uint64_t capacity);
+
+// Parse a batch of edges, one character at the time
+static uint64_t parse_edges_scalar(const char*& cursor, const char* end, bool is_weighted, uint64_t* sources, uint64_t* destinations, double* weights, uint64_t capacity){
+    uint64_t i = 0;
+    double weight = 0;
+    while(i < capacity && parse_edge(cursor, end, is_weighted, sources[i], destinations[i], weight)){
+        if(is_weighted) weights[i] = weight;
+        i++;
+    }
+    return i;
+}
+
+#if defined(__x86_64__)
+/**
+ * Vectorised tokenizer. Most lines of an edge list are short and regular, e.g. `12345 67890 1.5\n'. The tokenizer loads
+ * 32 (AVX2) or 64 (AVX-512) bytes at the start of each line and computes, with a handful of comparisons, the bitmasks
+ * of the digits, the blanks and the new lines in the block. The boundaries of the fields and of the line are then
+ * retrieved from the bitmasks with bit scans, and the digits of the vertex IDs are converted with SSE multiply-adds.
+ * Whatever does not fit the expected pattern (comments, empty lines, lines longer than the block, numbers with more
+ * than 19 digits, malformed lines) is handed to the scalar parser, so that the results and the errors raised are
+ * exactly the same.
+ */
+
+// Shuffle masks to right align a sequence of `len' digits in a 16 bytes register, padding with zeros on the left
+alignas(16) static const uint8_t simd_digits_shuffle_masks[17][16] = {
+#define SHUFFLE_MASK(len) { \
+    (0 >= 16 - len) ? 0 - (16 - len) : 0x80, (1 >= 16 - len) ? 1 - (16 - len) : 0x80, (2 >= 16 - len) ? 2 - (16 - len) : 0x80, (3 >= 16 - len) ? 3 - (16 - len) : 0x80, \
+    (4 >= 16 - len) ? 4 - (16 - len) : 0x80, (5 >= 16 - len) ? 5 - (16 - len) : 0x80, (6 >= 16 - len) ? 6 - (16 - len) : 0x80, (7 >= 16 - len) ? 7 - (16 - len) : 0x80, \
+    (8 >= 16 - len) ? 8 - (16 - len) : 0x80, (9 >= 16 - len) ? 9 - (16 - len) : 0x80, (10 >= 16 - len) ? 10 - (16 - len) : 0x80, (11 >= 16 - len) ? 11 - (16 - len) : 0x80, \
+    (12 >= 16 - len) ? 12 - (16 - len) : 0x80, (13 >= 16 - len) ? 13 - (16 - len) : 0x80, (14 >= 16 - len) ? 14 - (16 - len) : 0x80, (15 >= 16 - len) ? 15 - (16 - len) : 0x80 }
+    SHUFFLE_MASK(0), SHUFFLE_MASK(1), SHUFFLE_MASK(2), SHUFFLE_MASK(3), SHUFFLE_MASK(4), SHUFFLE_MASK(5), SHUFFLE_MASK(6),
+    SHUFFLE_MASK(7), SHUFFLE_MASK(8), SHUFFLE_MASK(9), SHUFFLE_MASK(10), SHUFFLE_MASK(11), SHUFFLE_MASK(12), SHUFFLE_MASK(13),
+    SHUFFLE_MASK(14), SHUFFLE_MASK(15), SHUFFLE_MASK(16)
+#undef SHUFFLE_MASK
+};
+
+// Convert a sequence of 1 <= len <= 16 digits into an integer. The 16 bytes [digits, digits + 16) must be readable.
+__attribute__((target("sse4.1")))
+static inline uint64_t simd_convert_digits16(const char* digits, uint64_t len){
+    assert(len >= 1 && len <= 16);
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits));
+    v = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    v = _mm_shuffle_epi8(v, _mm_load_si128(reinterpret_cast<const __m128i*>(simd_digits_shuffle_masks[len])));
+    v = _mm_maddubs_epi16(v, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1)); // 8 x 2 digits
+    v = _mm_madd_epi16(v, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1)); // 4 x 4 digits
+    v = _mm_packus_epi32(v, v);
+    v = _mm_madd_epi16(v, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1)); // 2 x 8 digits
+    return static_cast<uint64_t>(static_cast<uint32_t>(_mm_cvtsi128_si32(v))) * 100000000ull + static_cast<uint32_t>(_mm_extract_epi32(v, 1));
+}
+
+// Convert a sequence of 1 <= len <= 19 digits into an integer. Only the bytes in [digits, limit) are known to be
+// readable, with digits + len <= limit. Short sequences too close to the limit to load 16 bytes are converted one
+// digit at the time.
+__attribute__((target("sse4.1")))
+static inline uint64_t simd_convert_digits(const char* digits, uint64_t len, const char* limit){
+    if(len <= 16){
+        if(limit - digits < 16){
+            const char* marker = digits;
+            return scan_uint64(marker, digits + len);
+        }
+        return simd_convert_digits16(digits, len);
+    } else {
+        uint64_t prefix = 0;
+        for(uint64_t i = 0, end = len - 16; i < end; i++){ prefix = prefix * 10 + (digits[i] - '0'); }
+        return prefix * 10000000000000000ull + simd_convert_digits16(digits + len - 16, 16);
+    }
+}
+
+// Position of the first bit set in the mask at or after the position `from', or 64 if there is none
+static inline uint64_t simd_first_set(uint64_t mask, uint64_t from){
+    if(from >= 64) return 64;
+    mask &= (~0ull << from);
+    return mask == 0 ? 64 : __builtin_ctzll(mask);
+}
+
+// Parse the line starting at `line' given the bitmasks of its first `width' bytes. Return false if the line does not
+// match the pattern of a regular edge, in which case it needs to be processed by the scalar parser.
+__attribute__((target("sse4.1")))
+static inline bool simd_parse_line(const char*& cursor, const char* end, uint64_t width, uint64_t mask_digits, uint64_t mask_blanks, uint64_t mask_newlines, bool is_weighted, uint64_t& source, uint64_t& destination, double& weight){
+    const char* line = cursor;
+    const uint64_t not_digits = ~mask_digits;
+    const uint64_t not_blanks = ~mask_blanks;
+    if((mask_digits & 1) == 0) return false; // comment, empty line, leading blanks or an error
+
+    // source
+    uint64_t source_len = simd_first_set(not_digits, 0);
+    if(source_len > 19 || source_len >= width) return false;
+
+    // destination
+    uint64_t destination_start = simd_first_set(not_blanks, source_len);
+    if(destination_start >= width || (mask_digits & (1ull << destination_start)) == 0) return false;
+    uint64_t destination_end = simd_first_set(not_digits, destination_start);
+    uint64_t destination_len = destination_end - destination_start;
+    if(destination_len > 19 || destination_end >= width) return false;
+
+    // weight
+    uint64_t line_pos = destination_end; // offset of the first character not parsed
+    if(is_weighted){
+        uint64_t weight_start = simd_first_set(not_blanks, destination_end);
+        if(weight_start >= width || (mask_digits & (1ull << weight_start)) == 0) return false;
+        const char* marker = line + weight_start;
+        weight = scan_double(marker, end);
+        line_pos = marker - line;
+    }
+
+    source = simd_convert_digits(line, source_len, line + width);
+    destination = simd_convert_digits(line + destination_start, destination_len, line + width);
+
+    // move to the next line
+    uint64_t eol = simd_first_set(mask_newlines, line_pos);
+    if(eol < width){
+        cursor = line + eol +1;
+    } else {
+        cursor = line + line_pos;
+        skip_line(cursor, end);
+    }
+    return true;
+}
+
+// Parse a batch of edges, processing 32 bytes at the time
+__attribute__((target("avx2")))
+static uint64_t parse_edges_avx2(const char*& cursor, const char* end, bool is_weighted, uint64_t* sources, uint64_t* destinations, double* weights, uint64_t capacity){
+    constexpr uint64_t width = 32;
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i four = _mm256_set1_epi8(4);
+    const __m256i newline = _mm256_set1_epi8('\n');
+
+    uint64_t i = 0;
+    double weight = 0;
+    while(i < capacity && cursor < end){
+        bool parsed = false;
+        if(static_cast<uint64_t>(end - cursor) >= width){
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cursor));
+            __m256i d = _mm256_sub_epi8(v, zero);
+            uint64_t mask_digits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(d, nine), d)));
+            __m256i c = _mm256_sub_epi8(v, tab); // \t, \n, \v, \f, \r are consecutive
+            uint64_t mask_control = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(c, four), c)));
+            uint64_t mask_newlines = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, newline)));
+            uint64_t mask_blanks = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, space))) | (mask_control & ~mask_newlines);
+            parsed = simd_parse_line(cursor, end, width, mask_digits, mask_blanks, mask_newlines, is_weighted, sources[i], destinations[i], weight);
+        }
+        if(!parsed && !parse_edge(cursor, end, is_weighted, sources[i], destinations[i], weight)) break;
+        if(is_weighted) weights[i] = weight;
+        i++;
+    }
+    return i;
+}
+
+// Parse a batch of edges, processing 64 bytes at the time
+__attribute__((target("avx512f,avx512bw")))
+static uint64_t parse_edges_avx512(const char*& cursor, const char* end, bool is_weighted, uint64_t* sources, uint64_t* destinations, double* weights, uint64_t capacity){
+    constexpr uint64_t width = 64;
+    const __m512i zero = _mm512_set1_epi8('0');
+    const __m512i nine = _mm512_set1_epi8(9);
+    const __m512i space = _mm512_set1_epi8(' ');
+    const __m512i tab = _mm512_set1_epi8('\t');
+    const __m512i four = _mm512_set1_epi8(4);
+    const __m512i newline = _mm512_set1_epi8('\n');
+
+    uint64_t i = 0;
+    double weight = 0;
+    while(i < capacity && cursor < end){
+        bool parsed = false;
+        if(static_cast<uint64_t>(end - cursor) >= width){
+            __m512i v = _mm512_loadu_si512(cursor);
+            uint64_t mask_digits = _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, zero), nine);
+            uint64_t mask_control = _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, tab), four); // \t, \n, \v, \f, \r are consecutive
+            uint64_t mask_newlines = _mm512_cmpeq_epi8_mask(v, newline);
+            uint64_t mask_blanks = _mm512_cmpeq_epi8_mask(v, space) | (mask_control & ~mask_newlines);
+            parsed = simd_parse_line(cursor, end, width, mask_digits, mask_blanks, mask_newlines, is_weighted, sources[i], destinations[i], weight);
+        }
+        if(!parsed && !parse_edge(cursor, end, is_weighted, sources[i], destinations[i], weight)) break;
+        if(is_weighted) weights[i] = weight;
+        i++;
+    }
+    return i;
+}
+#endif
+
+// Select the fastest tokenizer supported by the CPU
+static parse_edges_t select_parse_edges(){
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512bw")){
+        COUT_DEBUG("AVX-512 tokenizer");
+        return parse_edges_avx512;
+    } else if(__builtin_cpu_supports("avx2")){
+        COUT_DEBUG("AVX2 tokenizer");
+        return parse_edges_avx2;
+    }
+#endif
+    COUT_DEBUG("scalar tokenizer");
+    return parse_edges_scalar;
+}
+
 /*****************************************************************************
  *                                                                           *
  *  Reader implementations                                                   *
@@ -80,6 +463,20 @@ public:
 
     // Read one vertex at the time
     virtual bool read_vertex(uint64_t& vertex_id) = 0;
+
+    // Read a batch of edges, return the number of edges read. By default, it relies on #read_edge
+    virtual uint64_t read_edges(uint64_t* sources, uint64_t* destinations, double* weights, uint64_t capacity){
+        uint64_t i = 0;
+        while(i < capacity && read_edge(sources[i], destinations[i], weights[i])){ i++; }
+        return i;
+    }
+
+    // Read a batch of vertices, return the number of vertices read. By default, it relies on #read_vertex
+    virtual uint64_t read_vertices(uint64_t* vertices, uint64_t capacity){
+        uint64_t i = 0;
+        while(i < capacity && read_vertex(vertices[i])){ i++; }
+        return i;
+    }
 };
 
 namespace  { // anonymous namespace
@@ -176,13 +573,369 @@ public:
 
 };
 
-template<typename T>
-class GraphalyticsZlibDecompressInput {
-    fstream m_handle; // I/O handle to read the data from the input file
+// read-only memory mapping of a whole file
+class MappedFile {
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* m_content { nullptr }; // the content of the file
+    uint64_t m_size { 0 }; // the size of the file, in bytes
+
+public:
+    MappedFile(const string& path){
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) ERROR("Cannot open the file `" << path << "': " << strerror(errno));
+
+        struct stat info;
+        if(::fstat(fd, &info) != 0){
+            int error_code = errno;
+            ::close(fd);
+            ERROR("Cannot retrieve the size of the file `" << path << "': " << strerror(error_code));
+        }
+        m_size = info.st_size;
+
+        if(m_size > 0){ // mmap does not accept empty mappings
+            void* content = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(content == MAP_FAILED){
+                int error_code = errno;
+                ::close(fd);
+                ERROR("Cannot memory map the file `" << path << "': " << strerror(error_code));
+            }
+            ::madvise(content, m_size, MADV_SEQUENTIAL); // ignore rc, it's only a hint
+            m_content = reinterpret_cast<const char*>(content);
+        }
+
+        ::close(fd); // the mapping is still valid after the file descriptor has been closed
+    }
+
+    ~MappedFile(){
+        if(m_content != nullptr){
+            ::munmap(const_cast<char*>(m_content), m_size);
+            m_content = nullptr;
+        }
+    }
+
+    // Start of the content
+    const char* begin() const { return m_content; }
+
+    // End of the content
+    const char* end() const { return m_content + m_size; }
+
+    // Size of the file, in bytes
+    uint64_t size() const { return m_size; }
+};
+
+// text format, the files are memory mapped and parsed in place, without copying each line in a string
+class GraphalyticsMmapReader : public GraphalyticsReaderBaseImpl {
+private:
+    MappedFile m_vertex_file; // mapping of the vertex file
+    MappedFile m_edge_file; // mapping of the edge file
+    const char* m_vertex_cursor; // current position in the vertex file
+    const char* m_edge_cursor; // current position in the edge file
+    const bool m_is_weighted; // whether the edge list contains weights
+    const parse_edges_t m_parse_edges; // tokenizer for the edge file
+
+    // parallel parsing of the edge file
+    const uint64_t m_num_threads; // number of threads to parse the edge file, 1 => sequential
+    constexpr static uint64_t m_chunk_size = (1ull << 23); // amount of text parsed by each thread in a window, 8 MB
+    struct EdgeBuffer { // edges parsed from a range of the edge file
+        std::vector<uint64_t> m_sources;
+        std::vector<uint64_t> m_destinations;
+        std::vector<double> m_weights;
+        std::exception_ptr m_error; // exception raised while parsing the range
+    };
+    std::vector<EdgeBuffer> m_window; // the edges parsed in the current window, one buffer per range, in file order
+    uint64_t m_window_range = 0; // current range in the window
+    uint64_t m_window_pos = 0; // current position in the current range
+    std::vector<EdgeBuffer> m_next_window; // the window being parsed in the background
+    std::vector<std::thread> m_workers; // threads parsing the next window
+
+    // Parse all edges in the range [start, end) into the given buffer. Executed by the worker threads.
+    static void parse_range(parse_edges_t parse_edges, const char* start, const char* end, bool is_weighted, EdgeBuffer* buffer){
+        try {
+            constexpr uint64_t batch_capacity = (1ull << 12);
+            uint64_t num_edges = 0;
+            uint64_t batch_sz = 0;
+            do {
+                buffer->m_sources.resize(num_edges + batch_capacity);
+                buffer->m_destinations.resize(num_edges + batch_capacity);
+                if(is_weighted) buffer->m_weights.resize(num_edges + batch_capacity);
+                batch_sz = parse_edges(start, end, is_weighted, buffer->m_sources.data() + num_edges, buffer->m_destinations.data() + num_edges,
+                        is_weighted ? buffer->m_weights.data() + num_edges : nullptr, batch_capacity);
+                num_edges += batch_sz;
+            } while(batch_sz == batch_capacity);
+
+            buffer->m_sources.resize(num_edges);
+            buffer->m_destinations.resize(num_edges);
+            buffer->m_weights.resize(is_weighted ? num_edges : 0);
+        } catch(...){
+            buffer->m_error = std::current_exception();
+        }
+    }
+
+    // Split the next portion of the edge file in ranges aligned to the lines and start parsing them in the background
+    void start_next_window(){
+        assert(m_workers.empty() && "The previous window is still being parsed");
+        const char* end = m_edge_file.end();
+        if(m_edge_cursor >= end) return; // depleted
+
+        const char* window_end = m_edge_cursor + std::min<uint64_t>(end - m_edge_cursor, m_num_threads * m_chunk_size);
+        if(window_end < end) skip_line(window_end, end); // align to the start of the next line
+
+        m_next_window.resize(m_num_threads);
+        uint64_t window_sz = window_end - m_edge_cursor;
+        const char* range_start = m_edge_cursor;
+        for(uint64_t i = 0; i < m_num_threads; i++){
+            const char* range_end = (i == m_num_threads -1) ? window_end : m_edge_cursor + (i +1) * window_sz / m_num_threads;
+            if(range_end < range_start) range_end = range_start;
+            if(range_end < window_end) skip_line(range_end, window_end);
+            m_workers.emplace_back(&GraphalyticsMmapReader::parse_range, m_parse_edges, range_start, range_end, m_is_weighted, &m_next_window[i]);
+            range_start = range_end;
+        }
+        m_edge_cursor = window_end;
+    }
+
+    // Wait for the window being parsed in the background to complete, make it the current window and start parsing the next one
+    bool fetch_next_window(){
+        if(m_workers.empty()) return false; // the edge file has been completely parsed
+
+        for(auto& worker : m_workers){ worker.join(); }
+        m_workers.clear();
+        for(auto& buffer : m_next_window){
+            if(buffer.m_error){
+                std::exception_ptr error = buffer.m_error;
+                buffer.m_error = nullptr;
+                std::rethrow_exception(error);
+            }
+        }
+
+        std::swap(m_window, m_next_window);
+        m_window_range = 0;
+        m_window_pos = 0;
+        start_next_window();
+        return true;
+    }
+
+    // Read the next edge from the windows parsed in parallel
+    bool read_edge_parallel(uint64_t& source, uint64_t& destination, double& weight){
+        while(m_window_range >= m_window.size() || m_window_pos >= m_window[m_window_range].m_sources.size()){
+            if(m_window_range < m_window.size()){
+                m_window_range++;
+                m_window_pos = 0;
+            } else if(!fetch_next_window()){
+                return false;
+            }
+        }
+
+        const EdgeBuffer& buffer = m_window[m_window_range];
+        source = buffer.m_sources[m_window_pos];
+        destination = buffer.m_destinations[m_window_pos];
+        weight = m_is_weighted ? buffer.m_weights[m_window_pos] : 0.0;
+        m_window_pos++;
+        return true;
+    }
+
+    // Copy a batch of edges from the windows parsed in parallel
+    uint64_t read_edges_parallel(uint64_t* sources, uint64_t* destinations, double* weights, uint64_t capacity){
+        uint64_t num_edges = 0;
+        while(num_edges < capacity){
+            if(m_window_range >= m_window.size()){
+                if(!fetch_next_window()) break;
+                continue;
+            }
+
+            const EdgeBuffer& buffer = m_window[m_window_range];
+            uint64_t count = std::min<uint64_t>(capacity - num_edges, buffer.m_sources.size() - m_window_pos);
+            memcpy(sources + num_edges, buffer.m_sources.data() + m_window_pos, count * sizeof(uint64_t));
+            memcpy(destinations + num_edges, buffer.m_destinations.data() + m_window_pos, count * sizeof(uint64_t));
+            if(m_is_weighted){
+                memcpy(weights + num_edges, buffer.m_weights.data() + m_window_pos, count * sizeof(double));
+            } else {
+                std::fill(weights + num_edges, weights + num_edges + count, 0.0);
+            }
+            num_edges += count;
+            m_window_pos += count;
+
+            if(m_window_pos >= buffer.m_sources.size()){
+                m_window_range++;
+                m_window_pos = 0;
+            }
+        }
+
+        return num_edges;
+    }
+
+public:
+    GraphalyticsMmapReader(const string& path_vertex_file, const string& path_edge_file, bool is_weighted, uint64_t num_threads) :
+        m_vertex_file(path_vertex_file), m_edge_file(path_edge_file), m_is_weighted(is_weighted), m_parse_edges(select_parse_edges()), m_num_threads(std::max<uint64_t>(1, num_threads)) {
+        COUT_DEBUG("mmap, vertex file: `" << path_vertex_file << "', edge file: `" << path_edge_file << "', num threads: " << m_num_threads);
+        m_vertex_cursor = m_vertex_file.begin();
+        m_edge_cursor = m_edge_file.begin();
+        if(m_num_threads > 1){ start_next_window(); }
+    }
+
+    virtual ~GraphalyticsMmapReader(){
+        for(auto& worker : m_workers){ worker.join(); }
+    }
+
+    // read one edge at the time from the edge file
+    bool read_edge(uint64_t& source, uint64_t& destination, double& weight) override {
+        if(m_num_threads > 1){
+            return read_edge_parallel(source, destination, weight);
+        } else {
+            return parse_edge(m_edge_cursor, m_edge_file.end(), m_is_weighted, source, destination, weight);
+        }
+    }
+
+    // read a batch of edges from the edge file
+    uint64_t read_edges(uint64_t* sources, uint64_t* destinations, double* weights, uint64_t capacity) override {
+        if(m_num_threads > 1){
+            return read_edges_parallel(sources, destinations, weights, capacity);
+        } else {
+            uint64_t num_edges = m_parse_edges(m_edge_cursor, m_edge_file.end(), m_is_weighted, sources, destinations, weights, capacity);
+            if(!m_is_weighted){ std::fill(weights, weights + num_edges, 0.0); }
+            return num_edges;
+        }
+    }
+
+    // read one vertex at the time from the vertex file
+    bool read_vertex(uint64_t& out_vertex) override {
+        out_vertex = 0; // init
+
+        const char* end = m_vertex_file.end();
+        if(!next_line(m_vertex_cursor, end)) return false;
+        if(!is_digit(m_vertex_cursor[0])) ERROR("line: `" << get_line(m_vertex_cursor, end) << "', cannot read the vertex id");
+        out_vertex = scan_uint64(m_vertex_cursor, end);
+
+        skip_line(m_vertex_cursor, end);
+        return true;
+    }
+
+    // read a batch of vertices from the vertex file
+    uint64_t read_vertices(uint64_t* vertices, uint64_t capacity) override {
+        uint64_t i = 0;
+        while(i < capacity && read_vertex(vertices[i])){ i++; }
+        return i;
+    }
+};
+
+// Streaming decompressor for the zlib format
+class ZlibDecoder {
     z_stream m_stream; // zlib handle to decompress the content
-    constexpr static uint64_t m_buffer_capacity = (1<<15) * sizeof(T); // the capacity of the handles, in bytes
-    uint8_t* m_input_buffer { nullptr }; // the content read from the input vertex file
-    uint8_t* m_output_buffer { nullptr }; // the content decompressed from the library
+
+public:
+    ZlibDecoder(){
+        m_stream.zalloc = Z_NULL;
+        m_stream.zfree = Z_NULL;
+        m_stream.opaque = Z_NULL;
+        m_stream.avail_in = 0;
+        m_stream.next_in = Z_NULL;
+        m_stream.avail_out = 0;
+        m_stream.next_out = nullptr;
+        int rc = inflateInit(&m_stream);
+        if(rc != Z_OK) ERROR("Cannot initialise the library zlib");
+    }
+
+    ~ZlibDecoder(){
+        inflateEnd(&m_stream); // ignore rc
+    }
+
+    // Decompress the content of `input' into `output'. Advance the input by the bytes consumed and return the number of bytes produced
+    uint64_t decompress(const uint8_t*& input, uint64_t& input_sz, uint8_t* output, uint64_t output_sz){
+        m_stream.next_in = const_cast<uint8_t*>(input);
+        m_stream.avail_in = input_sz;
+        m_stream.next_out = output;
+        m_stream.avail_out = output_sz;
+        int rc = inflate(&m_stream, Z_NO_FLUSH);
+        // Z_BUF_ERROR only signals that no progress was possible, e.g. the input has been depleted
+        if(rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) ERROR("Cannot decompress the input stream: " << m_stream.msg << " (rc: " << rc << ")");
+        input = m_stream.next_in;
+        input_sz = m_stream.avail_in;
+        return output_sz - m_stream.avail_out;
+    }
+};
+
+#if defined(HAVE_ZSTD)
+// Streaming decompressor for the Zstandard format
+class ZstdDecoder {
+    ZSTD_DCtx* m_context { nullptr }; // zstd handle to decompress the content
+
+public:
+    ZstdDecoder(){
+        m_context = ZSTD_createDCtx();
+        if(m_context == nullptr) ERROR("Cannot initialise the library zstd");
+    }
+
+    ~ZstdDecoder(){
+        ZSTD_freeDCtx(m_context); // ignore rc
+    }
+
+    // Decompress the content of `input' into `output'. Advance the input by the bytes consumed and return the number of bytes produced
+    uint64_t decompress(const uint8_t*& input, uint64_t& input_sz, uint8_t* output, uint64_t output_sz){
+        ZSTD_inBuffer zinput { input, input_sz, 0 };
+        ZSTD_outBuffer zoutput { output, output_sz, 0 };
+        size_t rc = ZSTD_decompressStream(m_context, &zoutput, &zinput);
+        if(ZSTD_isError(rc)) ERROR("Cannot decompress the input stream: " << ZSTD_getErrorName(rc));
+        input += zinput.pos;
+        input_sz -= zinput.pos;
+        return zoutput.pos;
+    }
+};
+#endif
+
+#if defined(HAVE_LZ4)
+// Streaming decompressor for the LZ4 frame format
+class Lz4Decoder {
+    LZ4F_dctx* m_context { nullptr }; // lz4 handle to decompress the content
+
+public:
+    Lz4Decoder(){
+        LZ4F_errorCode_t rc = LZ4F_createDecompressionContext(&m_context, LZ4F_VERSION);
+        if(LZ4F_isError(rc)) ERROR("Cannot initialise the library lz4: " << LZ4F_getErrorName(rc));
+    }
+
+    ~Lz4Decoder(){
+        LZ4F_freeDecompressionContext(m_context); // ignore rc
+    }
+
+    // Decompress the content of `input' into `output'. Advance the input by the bytes consumed and return the number of bytes produced
+    uint64_t decompress(const uint8_t*& input, uint64_t& input_sz, uint8_t* output, uint64_t output_sz){
+        size_t bytes_consumed = input_sz;
+        size_t bytes_produced = output_sz;
+        size_t rc = LZ4F_decompress(m_context, output, &bytes_produced, input, &bytes_consumed, /* options */ nullptr);
+        if(LZ4F_isError(rc)) ERROR("Cannot decompress the input stream: " << LZ4F_getErrorName(rc));
+        input += bytes_consumed;
+        input_sz -= bytes_consumed;
+        return bytes_produced;
+    }
+};
+#endif
+
+/**
+ * Read a sequence of items of type T from a file compressed as a single stream. The template parameter Decoder wraps
+ * the library for the actual compression format (zlib, zstd or lz4). A background thread reads ahead the next chunks
+ * of the file, up to m_num_chunks, while the current chunk is being decompressed.
+ */
+template<typename T, typename Decoder>
+class GraphalyticsDecompressInput {
+    fstream m_handle; // I/O handle to read the data from the input file
+    Decoder m_decoder; // library handle to decompress the content
+    const uint64_t m_buffer_capacity; // the capacity of the chunks and of the output buffer, in bytes
+    constexpr static uint64_t m_num_chunks = 3; // number of chunks read ahead from the input file
+    unique_ptr<uint8_t[]> m_chunks[m_num_chunks]; // the content read from the input file
+    uint64_t m_chunk_sizes[m_num_chunks]; // the number of bytes read in each chunk
+    uint64_t m_chunks_produced = 0; // number of chunks filled by the read-ahead thread, protected by m_mutex
+    uint64_t m_chunks_consumed = 0; // number of chunks released by the decoder, protected by m_mutex
+    bool m_has_chunk = false; // whether the decoder holds the chunk m_chunks_consumed % m_num_chunks
+    bool m_input_eof = false; // whether the read-ahead thread reached the end of the file, protected by m_mutex
+    bool m_input_error = false; // whether the read-ahead thread failed to read from the file, protected by m_mutex
+    bool m_terminate = false; // request the read-ahead thread to terminate, protected by m_mutex
+    mutex m_mutex; // synchronise the decoder and the read-ahead thread
+    condition_variable m_condvar; // wait for a chunk to be read or released
+    thread m_read_ahead; // background thread reading the input file
+    const uint8_t* m_input_cursor { nullptr }; // first byte in the current chunk not consumed yet by the decoder
+    uint64_t m_input_sz = 0; // number of bytes in the current chunk not consumed yet by the decoder
+    unique_ptr<uint8_t[]> m_output_buffer; // the content decompressed from the library
     uint64_t m_output_pos = 0; // current position in the output buffer
     uint64_t m_output_sz = 0; // number of vertices in the output buffer
     uint64_t m_output_leftover_sz = 0; // bytes decompressed from the output that do not reach sizeof(T)
@@ -198,78 +951,340 @@ class GraphalyticsZlibDecompressInput {
     }
 
 public:
-    GraphalyticsZlibDecompressInput(const string& path_vertex_file){
+    GraphalyticsDecompressInput(const string& path_vertex_file, uint64_t buffer_capacity) : m_buffer_capacity(std::max<uint64_t>(buffer_capacity, 2 * sizeof(T))) {
         m_handle.open(path_vertex_file, ios::in | ios::binary);
         if(!m_handle.good()){ ERROR("Cannot open the input file: " << path_vertex_file); }
 
-        m_input_buffer = new uint8_t[m_buffer_capacity];
-        m_output_buffer = new uint8_t[m_buffer_capacity];
+        for(uint64_t i = 0; i < m_num_chunks; i++){
+            m_chunks[i].reset( new uint8_t[m_buffer_capacity] );
+            m_chunk_sizes[i] = 0;
+        }
+        m_output_buffer.reset( new uint8_t[m_buffer_capacity] );
 
-        m_stream.zalloc = Z_NULL;
-        m_stream.zfree = Z_NULL;
-        m_stream.opaque = Z_NULL;
-        m_stream.avail_in = 0;
-        m_stream.next_in = m_input_buffer;
-        m_stream.avail_out = 0;
-        m_stream.next_out = nullptr;
-        int rc = inflateInit(&m_stream);
-        if(rc != Z_OK) ERROR("Cannot initialise the library zlib");
+        m_read_ahead = thread { &GraphalyticsDecompressInput::main_read_ahead, this };
     }
 
-    ~GraphalyticsZlibDecompressInput(){
-        inflateEnd(&m_stream); // ignore rc
+    ~GraphalyticsDecompressInput(){
+        { // restrict the scope
+            scoped_lock<mutex> lock(m_mutex);
+            m_terminate = true;
+        }
+        m_condvar.notify_all();
+        m_read_ahead.join();
         m_handle.close();
-        delete m_input_buffer; m_input_buffer = nullptr;
-        delete m_output_buffer; m_output_buffer = nullptr;
     }
 
+private:
+    // Main loop of the read-ahead thread
+    void main_read_ahead(){
+        unique_lock<mutex> lock(m_mutex);
+        while(true){
+            m_condvar.wait(lock, [this](){ return m_terminate || m_chunks_produced - m_chunks_consumed < m_num_chunks; });
+            if(m_terminate) break;
+            uint64_t index = m_chunks_produced % m_num_chunks;
+            lock.unlock();
+
+            // the decoder never holds the chunk being read, as m_chunks_consumed <= m_chunks_produced < m_chunks_consumed + m_num_chunks
+            m_handle.read((char*) m_chunks[index].get(), m_buffer_capacity);
+            uint64_t data_read = m_handle.gcount();
+            bool is_eof = !m_handle.good();
+            bool is_error = m_handle.bad();
+
+            lock.lock();
+            m_chunk_sizes[index] = data_read;
+            if(data_read > 0) m_chunks_produced++;
+            m_input_eof = is_eof;
+            m_input_error = is_error;
+            m_condvar.notify_all();
+            if(is_eof) break;
+        }
+    }
+
+    // Release the current chunk to the read-ahead thread and wait for the next one. Return false if the input file has been depleted.
+    bool next_chunk(){
+        unique_lock<mutex> lock(m_mutex);
+        if(m_has_chunk){
+            m_chunks_consumed++;
+            m_has_chunk = false;
+            m_condvar.notify_all();
+        }
+
+        m_condvar.wait(lock, [this](){ return m_chunks_produced > m_chunks_consumed || m_input_eof; });
+        if(m_input_error) ERROR("Cannot read from the input file");
+        if(m_chunks_produced == m_chunks_consumed) return false; // depleted
+
+        uint64_t index = m_chunks_consumed % m_num_chunks;
+        m_has_chunk = true;
+        m_input_cursor = m_chunks[index].get();
+        m_input_sz = m_chunk_sizes[index];
+        return true;
+    }
+
+    // Decompress the next chunk of the input file in the output buffer. Return false if the input file has been depleted.
+    bool refill(){
+        assert(m_output_pos >= m_output_sz && "The output buffer has not been consumed yet");
+
+        // fetch the next chunk of the input file
+        if(m_input_sz == 0){ next_chunk(); }
+
+        // copy the remaining m_output_leftover at the start of the stream
+        uint8_t* output_buffer = m_output_buffer.get();
+        memmove(output_buffer, output_buffer + m_output_sz, m_output_leftover_sz);
+        m_output_pos = m_output_sz = 0;
+        uint64_t output_buffer_sz = m_buffer_capacity - m_output_leftover_sz;
+
+        // decompress the input. Even when the whole file has been read, the decoder may still hold some pending output
+        uint64_t input_sz = m_input_sz;
+        uint64_t output_sz = m_decoder.decompress(m_input_cursor, m_input_sz, output_buffer + m_output_leftover_sz, output_buffer_sz);
+        if(output_sz == 0 && m_input_sz == input_sz) return false; // no progress, the stream is over
+        uint64_t data_processed = m_output_leftover_sz + output_sz;
+
+        m_output_sz = (/* truncate */ data_processed / sizeof(T)) * sizeof(T);
+        m_output_leftover_sz = data_processed % sizeof(T);
+
+        return true;
+    }
+
+public:
     bool read(T* item){
-        if(m_output_pos >= m_output_sz){
-            // read the content from the input file
-            if(m_stream.avail_in == 0){
-                if(!m_handle.good()) return false; // depleted
+        while(m_output_pos >= m_output_sz){ if(!refill()) return false; }
+
+        assert(m_output_sz > 0 && "Empty output");
+        assert(m_output_pos < m_output_sz && "Current output buffer depleted");
+        assign(item, reinterpret_cast<T*>(m_output_buffer.get() + m_output_pos));
+        m_output_pos += sizeof(T);
+        return true;
+    }
+
+    // Retrieve up to `capacity' items directly from the output buffer, without copying them. The pointer is valid
+    // until the next invocation of #read or #fetch. Return the number of items available, 0 if the input is depleted.
+    uint64_t fetch(const T** out_items, uint64_t capacity){
+        while(m_output_pos >= m_output_sz){ if(!refill()) return 0; }
+
+        uint64_t count = std::min<uint64_t>(capacity, (m_output_sz - m_output_pos) / sizeof(T));
+        *out_items = reinterpret_cast<const T*>(m_output_buffer.get() + m_output_pos);
+        m_output_pos += count * sizeof(T);
+        return count;
+    }
 
-                m_handle.read((char*) m_input_buffer, m_buffer_capacity);
-                uint64_t data_read = m_handle.gcount();
+    // Copy up to `capacity' items in the given array. Return the number of items read, 0 if the input is depleted.
+    uint64_t read(T* items, uint64_t capacity){
+        uint64_t num_items = 0;
+        const T* batch = nullptr;
+        uint64_t count = 0;
+        while(num_items < capacity && (count = fetch(&batch, capacity - num_items)) > 0){
+            memcpy(items + num_items, batch, count * sizeof(T));
+            num_items += count;
+        }
+        return num_items;
+    }
+};
 
-                m_stream.next_in = m_input_buffer;
-                m_stream.avail_in = data_read;
+template<typename T>
+using GraphalyticsZlibDecompressInput = GraphalyticsDecompressInput<T, ZlibDecoder>;
+#if defined(HAVE_ZSTD)
+template<typename T>
+using GraphalyticsZstdDecompressInput = GraphalyticsDecompressInput<T, ZstdDecoder>;
+#endif
+#if defined(HAVE_LZ4)
+template<typename T>
+using GraphalyticsLz4DecompressInput = GraphalyticsDecompressInput<T, Lz4Decoder>;
+#endif
+
+/**
+ * Blocked variant of the zlib format. The file is a sequence of independent zlib streams (blocks), each containing
+ * a whole number of items. A sidecar file with the same path and the suffix `.index' stores, for each block, its
+ * offset in the file and the number of items it contains, as two little endian uint64_t. As the blocks are
+ * independent, they are inflated by a pool of threads, while they are still reported in the order of the file.
+ */
+template<typename T>
+class GraphalyticsZlibBlockedInput {
+    GraphalyticsZlibBlockedInput(const GraphalyticsZlibBlockedInput&) = delete;
+    GraphalyticsZlibBlockedInput& operator=(const GraphalyticsZlibBlockedInput&) = delete;
+
+    struct Block { uint64_t m_offset; uint64_t m_size; uint64_t m_num_items; }; // entry in the sidecar index
+    struct Slot { std::vector<uint8_t> m_content; bool m_ready = false; std::exception_ptr m_error; }; // a block inflated
+    const string m_path; // path to the input file, for error messages
+    int m_fd = -1; // file descriptor of the input file, shared by the workers through pread
+    std::vector<Block> m_blocks; // the content of the index
+    std::vector<Slot> m_slots; // blocks inflated and pending to be consumed, in a ring. Block i is stored in the slot i % m_slots.size()
+    std::vector<std::thread> m_workers; // the threads inflating the blocks
+    std::mutex m_mutex; // sync the workers and the consumer
+    std::condition_variable m_condvar;
+    uint64_t m_next_block_assigned = 0; // next block to be inflated by a worker
+    uint64_t m_next_block_consumed = 0; // block being read or the next block to be read by the consumer
+    bool m_has_block = false; // whether the consumer is reading the block m_next_block_consumed
+    bool m_terminate = false; // request the workers to terminate
+    const uint8_t* m_output_buffer { nullptr }; // content of the current block
+    uint64_t m_output_pos = 0; // current position in the output buffer
+    uint64_t m_output_sz = 0; // size of the output buffer, in bytes
+
+    // Load the sidecar index
+    void load_index(const string& path_index){
+        fstream handle(path_index, ios::in | ios::binary);
+        if(!handle.good()){ ERROR("Cannot open the index file: " << path_index); }
+        uint64_t entry[2];
+        while(handle.read(reinterpret_cast<char*>(entry), sizeof(entry))){
+            m_blocks.push_back(Block{ entry[0], 0, entry[1] });
+        }
+        if(handle.gcount() != 0){ ERROR("The index file `" << path_index << "' is truncated"); }
+
+        // infer the size of each block from the offset of the following one
+        struct stat info;
+        if(::fstat(m_fd, &info) != 0){ ERROR("Cannot retrieve the size of the file `" << m_path << "': " << strerror(errno)); }
+        for(uint64_t i = 0; i < m_blocks.size(); i++){
+            uint64_t block_end = (i +1 < m_blocks.size()) ? m_blocks[i +1].m_offset : static_cast<uint64_t>(info.st_size);
+            if(block_end < m_blocks[i].m_offset || block_end > static_cast<uint64_t>(info.st_size)){
+                ERROR("Invalid offset for the block #" << i << " in the index file `" << path_index << "': " << m_blocks[i].m_offset);
             }
+            m_blocks[i].m_size = block_end - m_blocks[i].m_offset;
+        }
+    }
 
-            // copy the remaining m_output_leftover at the start of the stream
-            memmove(m_output_buffer, m_output_buffer + m_output_sz, m_output_leftover_sz);
-            uint64_t output_buffer_sz = m_buffer_capacity - m_output_leftover_sz;
+    // Read & inflate the given block in the slot
+    void inflate_block(const Block& block, Slot& slot) const {
+        std::unique_ptr<uint8_t[]> input { new uint8_t[block.m_size] };
+        uint64_t bytes_read = 0;
+        while(bytes_read < block.m_size){
+            ssize_t rc = ::pread(m_fd, input.get() + bytes_read, block.m_size - bytes_read, block.m_offset + bytes_read);
+            if(rc < 0 && errno == EINTR) continue;
+            if(rc <= 0){ ERROR("Cannot read the file `" << m_path << "' at offset " << block.m_offset + bytes_read << ": " << (rc == 0 ? "unexpected end of file" : strerror(errno))); }
+            bytes_read += rc;
+        }
 
-            // decompress the input
-            m_stream.next_out = m_output_buffer + m_output_leftover_sz;
-            m_stream.avail_out = output_buffer_sz;
-            int rc = inflate(&m_stream, Z_NO_FLUSH);
-            if(rc != Z_OK && rc != Z_STREAM_END) ERROR("Cannot decompress the input stream: " << m_stream.msg << " (rc: " << rc << ")");
-            uint64_t data_processed = m_output_leftover_sz + (output_buffer_sz - m_stream.avail_out);
+        uLongf output_sz = block.m_num_items * sizeof(T);
+        slot.m_content.resize(output_sz);
+        int rc = uncompress(slot.m_content.data(), &output_sz, input.get(), block.m_size);
+        if(rc != Z_OK) ERROR("Cannot inflate the block at offset " << block.m_offset << " of the file `" << m_path << "' (rc: " << rc << ")");
+        if(output_sz != block.m_num_items * sizeof(T)) ERROR("The block at offset " << block.m_offset << " of the file `" << m_path << "' contains " << output_sz << " bytes, expected: " << block.m_num_items * sizeof(T));
+    }
+
+    // Main loop of the workers
+    void main_worker(){
+        while(true){
+            uint64_t block_id = 0;
+            { // fetch the next block to inflate
+                unique_lock<mutex> lock(m_mutex);
+                m_condvar.wait(lock, [this](){ return m_terminate || m_next_block_assigned >= m_blocks.size() || m_next_block_assigned < m_next_block_consumed + m_slots.size(); });
+                if(m_terminate || m_next_block_assigned >= m_blocks.size()) return;
+                block_id = m_next_block_assigned++;
+            }
 
-            m_output_pos = 0;
-            m_output_sz = (/* truncate */ data_processed / sizeof(T)) * sizeof(T);
-            m_output_leftover_sz = data_processed % sizeof(T);
-            assert((rc == Z_OK) || (rc == Z_STREAM_END || m_output_leftover_sz == 0));
+            Slot& slot = m_slots[block_id % m_slots.size()];
+            try {
+                inflate_block(m_blocks[block_id], slot);
+            } catch(...){
+                slot.m_error = std::current_exception();
+            }
+
+            { // notify the consumer
+                scoped_lock<mutex> lock(m_mutex);
+                slot.m_ready = true;
+            }
+            m_condvar.notify_all();
         }
+    }
 
-        assert(m_output_sz > 0 && "Empty output");
-        assert(m_output_pos < m_output_sz && "Current output buffer depleted");
-        assign(item, reinterpret_cast<T*>(m_output_buffer + m_output_pos));
+    // Move to the next block in the file. Return false if the input has been depleted.
+    bool next_block(){
+        unique_lock<mutex> lock(m_mutex);
+        if(m_has_block){ // release the current block
+            m_slots[m_next_block_consumed % m_slots.size()].m_ready = false;
+            m_next_block_consumed++;
+            m_has_block = false;
+            m_output_buffer = nullptr;
+            m_output_pos = m_output_sz = 0;
+            m_condvar.notify_all();
+        }
+        if(m_next_block_consumed >= m_blocks.size()) return false; // depleted
+
+        Slot& slot = m_slots[m_next_block_consumed % m_slots.size()];
+        m_condvar.wait(lock, [&slot](){ return slot.m_ready; });
+        m_has_block = true;
+        if(slot.m_error){
+            std::exception_ptr error = slot.m_error;
+            slot.m_error = nullptr;
+            std::rethrow_exception(error);
+        }
+
+        m_output_buffer = slot.m_content.data();
+        m_output_pos = 0;
+        m_output_sz = slot.m_content.size();
+        return true;
+    }
+
+public:
+    GraphalyticsZlibBlockedInput(const string& path, uint64_t num_threads) : m_path(path) {
+        m_fd = ::open(path.c_str(), O_RDONLY);
+        if(m_fd < 0){ ERROR("Cannot open the input file: " << path); }
+        try {
+            load_index(path + ".index");
+        } catch(...){
+            ::close(m_fd); m_fd = -1;
+            throw;
+        }
+        COUT_DEBUG("file: " << path << ", blocks: " << m_blocks.size() << ", threads: " << num_threads);
+
+        num_threads = std::max<uint64_t>(1, std::min<uint64_t>(num_threads, m_blocks.size()));
+        m_slots.resize(2 * num_threads); // let the workers inflate up to two blocks ahead each
+        for(uint64_t i = 0; i < num_threads; i++){
+            m_workers.emplace_back(&GraphalyticsZlibBlockedInput::main_worker, this);
+        }
+    }
+
+    ~GraphalyticsZlibBlockedInput(){
+        { // restrict the scope
+            scoped_lock<mutex> lock(m_mutex);
+            m_terminate = true;
+        }
+        m_condvar.notify_all();
+        for(auto& worker : m_workers){ worker.join(); }
+        if(m_fd >= 0){ ::close(m_fd); m_fd = -1; }
+    }
+
+    bool read(T* item){
+        while(m_output_pos >= m_output_sz){ if(!next_block()) return false; }
+
+        memcpy(item, m_output_buffer + m_output_pos, sizeof(T));
         m_output_pos += sizeof(T);
         return true;
     }
+
+    // Retrieve up to `capacity' items directly from the current block, without copying them. The pointer is valid
+    // until the next invocation of #read or #fetch. Return the number of items available, 0 if the input is depleted.
+    uint64_t fetch(const T** out_items, uint64_t capacity){
+        while(m_output_pos >= m_output_sz){ if(!next_block()) return 0; }
+
+        uint64_t count = std::min<uint64_t>(capacity, (m_output_sz - m_output_pos) / sizeof(T));
+        *out_items = reinterpret_cast<const T*>(m_output_buffer + m_output_pos);
+        m_output_pos += count * sizeof(T);
+        return count;
+    }
+
+    // Copy up to `capacity' items in the given array. Return the number of items read, 0 if the input is depleted.
+    uint64_t read(T* items, uint64_t capacity){
+        uint64_t num_items = 0;
+        const T* batch = nullptr;
+        uint64_t count = 0;
+        while(num_items < capacity && (count = fetch(&batch, capacity - num_items)) > 0){
+            memcpy(items + num_items, batch, count * sizeof(T));
+            num_items += count;
+        }
+        return num_items;
+    }
 };
 
-// zlib format, non weighted
-class GraphalyticsZlibReader2 : public GraphalyticsReaderBaseImpl {
+// compressed format, non weighted. The template parameter is the decompressor: zlib (single stream or blocked), zstd or lz4.
+template<template<typename> class Input>
+class GraphalyticsCompressedReader2 : public GraphalyticsReaderBaseImpl {
 private:
-    GraphalyticsZlibDecompressInput<uint64_t> m_vertices; // reader for the vertex file
-    GraphalyticsZlibDecompressInput<uint64_t[2]> m_edges; // reader for the edge file
+    Input<uint64_t> m_vertices; // reader for the vertex file
+    Input<uint64_t[2]> m_edges; // reader for the edge file
 
 public:
-    GraphalyticsZlibReader2(const string& path_vertex_file, const string& path_edge_file) : m_vertices(path_vertex_file), m_edges(path_edge_file) {
-        COUT_DEBUG("zlib, non weighted");
+    template<typename... Args>
+    GraphalyticsCompressedReader2(const string& path_vertex_file, const string& path_edge_file, Args... args) : m_vertices(path_vertex_file, args...), m_edges(path_edge_file, args...) {
+        COUT_DEBUG("compressed, non weighted");
     }
 
     // read one edge at the time from the edge file
@@ -283,21 +1298,44 @@ public:
         return true;
     }
 
+    // read a batch of edges from the edge file
+    uint64_t read_edges(uint64_t* sources, uint64_t* destinations, double* weights, uint64_t capacity) override {
+        uint64_t num_edges = 0;
+        const uint64_t (*batch)[2] = nullptr;
+        uint64_t count = 0;
+        while(num_edges < capacity && (count = m_edges.fetch(&batch, capacity - num_edges)) > 0){
+            for(uint64_t i = 0; i < count; i++){
+                sources[num_edges + i] = batch[i][0];
+                destinations[num_edges + i] = batch[i][1];
+                weights[num_edges + i] = 0;
+            }
+            num_edges += count;
+        }
+        return num_edges;
+    }
+
     // read one vertex at the time from the vertex file
     bool read_vertex(uint64_t& out_vertex) override {
         return m_vertices.read(&out_vertex);
     }
+
+    // read a batch of vertices from the vertex file
+    uint64_t read_vertices(uint64_t* vertices, uint64_t capacity) override {
+        return m_vertices.read(vertices, capacity);
+    }
 };
 
-// zlib format, weighted
-class GraphalyticsZlibReader3 : public GraphalyticsReaderBaseImpl {
+// compressed format, weighted. The template parameter is the decompressor: zlib (single stream or blocked), zstd or lz4.
+template<template<typename> class Input>
+class GraphalyticsCompressedReader3 : public GraphalyticsReaderBaseImpl {
 private:
-    GraphalyticsZlibDecompressInput<uint64_t> m_vertices; // reader for the vertex file
-    GraphalyticsZlibDecompressInput<uint64_t[3]> m_edges; // reader for the edge file
+    Input<uint64_t> m_vertices; // reader for the vertex file
+    Input<uint64_t[3]> m_edges; // reader for the edge file
 
 public:
-    GraphalyticsZlibReader3(const string& path_vertex_file, const string& path_edge_file) : m_vertices(path_vertex_file), m_edges(path_edge_file) {
-        COUT_DEBUG("zlib, weighted");
+    template<typename... Args>
+    GraphalyticsCompressedReader3(const string& path_vertex_file, const string& path_edge_file, Args... args) : m_vertices(path_vertex_file, args...), m_edges(path_edge_file, args...) {
+        COUT_DEBUG("compressed, weighted");
     }
 
     // read one edge at the time from the edge file
@@ -311,12 +1349,43 @@ public:
         return true;
     }
 
+    // read a batch of edges from the edge file
+    uint64_t read_edges(uint64_t* sources, uint64_t* destinations, double* weights, uint64_t capacity) override {
+        uint64_t num_edges = 0;
+        const uint64_t (*batch)[3] = nullptr;
+        uint64_t count = 0;
+        while(num_edges < capacity && (count = m_edges.fetch(&batch, capacity - num_edges)) > 0){
+            for(uint64_t i = 0; i < count; i++){
+                sources[num_edges + i] = batch[i][0];
+                destinations[num_edges + i] = batch[i][1];
+                weights[num_edges + i] = reinterpret_cast<const double*>(batch[i])[2];
+            }
+            num_edges += count;
+        }
+        return num_edges;
+    }
+
     // read one vertex at the time from the vertex file
     bool read_vertex(uint64_t& out_vertex) override {
         return m_vertices.read(&out_vertex);
     }
+
+    // read a batch of vertices from the vertex file
+    uint64_t read_vertices(uint64_t* vertices, uint64_t capacity) override {
+        return m_vertices.read(vertices, capacity);
+    }
 };
 
+// Create the reader for the compressed format, either weighted or non weighted
+template<template<typename> class Input, typename... Args>
+GraphalyticsReaderBaseImpl* make_compressed_reader(const string& path_vertex_file, const string& path_edge_file, bool is_weighted, Args... args){
+    if(!is_weighted){
+        return new GraphalyticsCompressedReader2<Input>( path_vertex_file, path_edge_file, args... );
+    } else {
+        return new GraphalyticsCompressedReader3<Input>( path_vertex_file, path_edge_file, args... );
+    }
+}
+
 } // anonymous namespace
 
 /*****************************************************************************
@@ -324,7 +1393,10 @@ public:
  *  External interface                                                       *
  *                                                                           *
  *****************************************************************************/
-GraphalyticsReader::GraphalyticsReader(const std::string& path_properties) {
+GraphalyticsReader::GraphalyticsReader(const std::string& path_properties, uint64_t num_threads, uint64_t buffer_size) :
+        GraphalyticsReader(path_properties, num_threads, buffer_size, /* open files ? */ true) { }
+
+GraphalyticsReader::GraphalyticsReader(const std::string& path_properties, uint64_t num_threads, uint64_t buffer_size, bool open_files) : m_num_threads(num_threads), m_buffer_size(buffer_size) {
     if(!common::filesystem::file_exists(path_properties)) ERROR("The given file does not exist: " << path_properties);
     string abs_path_properties = common::filesystem::absolute_path(path_properties);
     m_properties.insert({string("property-file"), abs_path_properties});
@@ -379,7 +1451,21 @@ GraphalyticsReader::GraphalyticsReader(const std::string& path_properties) {
                 }
         } else if ( key == "compression" ){
             if(value == "zlib"){
-                m_is_compressed = true;
+                m_compression = Compression::ZLIB;
+            } else if(value == "zlib-blocked"){
+                m_compression = Compression::ZLIB_BLOCKED;
+            } else if(value == "zstd"){
+#if defined(HAVE_ZSTD)
+                m_compression = Compression::ZSTD;
+#else
+                ERROR("Compression method not supported: " << value << ", the program has been built without the library zstd");
+#endif
+            } else if(value == "lz4"){
+#if defined(HAVE_LZ4)
+                m_compression = Compression::LZ4;
+#else
+                ERROR("Compression method not supported: " << value << ", the program has been built without the library lz4");
+#endif
             } else {
                 ERROR("Compression method not supported: " << value);
             }
@@ -399,24 +1485,46 @@ GraphalyticsReader::GraphalyticsReader(const std::string& path_properties) {
     COUT_DEBUG("vertex-file: " << get_path_vertex_list() << ", edge-file: " << get_path_edge_list() << ", is_directed: " << is_directed() << ", is_weighted: " << is_weighted() << ", is_compressed: " << is_compressed());
 
     // init the reader impl. (plain or compressed)
-    reset();
+    if(open_files){ reset(); }
 }
 
 GraphalyticsReader::~GraphalyticsReader(){
     delete m_impl; m_impl = nullptr;
 }
 
+bool GraphalyticsReader::is_weighted_graph(const std::string& path_properties){
+    GraphalyticsReader reader { path_properties, 1, default_buffer_size(), /* open files ? */ false };
+    return reader.is_weighted();
+}
+
+string GraphalyticsReader::read_property(const std::string& path_properties, const std::string& key){
+    GraphalyticsReader reader { path_properties, 1, default_buffer_size(), /* open files ? */ false };
+    return reader.get_property(key);
+}
+
 void GraphalyticsReader::reset(){
     delete m_impl; m_impl = nullptr;
 
     if(!is_compressed()){
-        m_impl = new GraphalyticsPlainReader{ get_path_vertex_list(), get_path_edge_list(), is_weighted() };
-    } else {
-        if(!is_weighted()){
-            m_impl = new GraphalyticsZlibReader2( get_path_vertex_list(), get_path_edge_list() );
+        // prefer to memory map the input files, unless they are pipes or special files
+        if(is_regular_file(get_path_vertex_list()) && is_regular_file(get_path_edge_list())){
+            m_impl = new GraphalyticsMmapReader{ get_path_vertex_list(), get_path_edge_list(), is_weighted(), m_num_threads };
         } else {
-            m_impl = new GraphalyticsZlibReader3( get_path_vertex_list(), get_path_edge_list() );
+            m_impl = new GraphalyticsPlainReader{ get_path_vertex_list(), get_path_edge_list(), is_weighted() };
         }
+    } else if(m_compression == Compression::ZLIB_BLOCKED){
+        m_impl = make_compressed_reader<GraphalyticsZlibBlockedInput>( get_path_vertex_list(), get_path_edge_list(), is_weighted(), m_num_threads );
+#if defined(HAVE_ZSTD)
+    } else if(m_compression == Compression::ZSTD){
+        m_impl = make_compressed_reader<GraphalyticsZstdDecompressInput>( get_path_vertex_list(), get_path_edge_list(), is_weighted(), m_buffer_size );
+#endif
+#if defined(HAVE_LZ4)
+    } else if(m_compression == Compression::LZ4){
+        m_impl = make_compressed_reader<GraphalyticsLz4DecompressInput>( get_path_vertex_list(), get_path_edge_list(), is_weighted(), m_buffer_size );
+#endif
+    } else {
+        assert(m_compression == Compression::ZLIB);
+        m_impl = make_compressed_reader<GraphalyticsZlibDecompressInput>( get_path_vertex_list(), get_path_edge_list(), is_weighted(), m_buffer_size );
     }
 }
 
@@ -446,7 +1554,7 @@ bool GraphalyticsReader::is_weighted() const {
 }
 
 bool GraphalyticsReader::is_compressed() const {
-    return m_is_compressed;
+    return m_compression != Compression::NONE;
 }
 
 bool GraphalyticsReader::read(uint64_t& out_source, uint64_t& out_destination, double& out_weight){
@@ -460,3 +1568,11 @@ bool GraphalyticsReader::read_edge(uint64_t& out_source, uint64_t& out_destinati
 bool GraphalyticsReader::read_vertex(uint64_t& out_vertex){
     return m_impl->read_vertex(out_vertex);
 }
+
+uint64_t GraphalyticsReader::read_edges(uint64_t* out_sources, uint64_t* out_destinations, double* out_weights, uint64_t capacity){
+    return m_impl->read_edges(out_sources, out_destinations, out_weights, capacity);
+}
+
+uint64_t GraphalyticsReader::read_vertices(uint64_t* out_vertices, uint64_t capacity){
+    return m_impl->read_vertices(out_vertices, capacity);
+}
\ No newline at end of file
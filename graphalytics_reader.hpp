@@ -19,10 +19,17 @@
  * There are multiple versions of this implementation:
  * - Version 1: support for only plain text
  * - Version 2: additional support for the vertex & edge files compressed for zlib
+ * - Version 3: plain text files are memory mapped and the edge file can be parsed by multiple threads
+ * - Version 4: support for the blocked zlib format (compression = zlib-blocked), where the vertex & edge files are
+ *   sequences of independent zlib streams, indexed by a sidecar file <file>.index, that can be inflated in parallel
+ * - Version 5: support for the vertex & edge files compressed with zstd (compression = zstd) or lz4 (compression = lz4),
+ *   available when the program is linked to the respective library
+ * - Version 6: the files compressed as a single stream are read ahead by a background thread, in chunks of configurable size
  */
 
 #pragma once
 
+#include <cstdint>
 #include <random>
 #include <unordered_map>
 
@@ -47,19 +54,46 @@ class GraphalyticsReader {
     GraphalyticsReaderBaseImpl* m_impl { nullptr }; // actual reader implementation
     uint64_t m_last_source {0}; uint64_t m_last_destination {0}; double m_last_weight{0.0}; // the last edge being parsed
     bool m_last_reported = true; // whether we have reported the last edge with source/dest vertices swapped in an undirected graph
-    bool m_is_compressed = false; // whether both the edge & vertex files have been compressed with zlib
+    enum class Compression { NONE, ZLIB, ZLIB_BLOCKED, ZSTD, LZ4 };
+    Compression m_compression = Compression::NONE; // whether both the edge & vertex files have been compressed, and with which library
+    const uint64_t m_num_threads; // number of threads to parse the edge file (plain text) or to decompress the input files (zlib-blocked)
+    const uint64_t m_buffer_size; // size of the chunks read ahead from the compressed input files (zlib, zstd & lz4), in bytes
+
+    // Parse the property file, and open the vertex & edge files only when `open_files' is true
+    GraphalyticsReader(const std::string& path_properties, uint64_t num_threads, uint64_t buffer_size, bool open_files);
 
 public:
     /**
      * Init the reader with the path to the graph property files (*.properties)
+     * @param num_threads number of threads to parse the edge file or to decompress the blocks of the input files in
+     *        parallel. The vertices and edges are still reported in the same order they appear in the files, regardless
+     *        of the number of threads used.
+     * @param buffer_size the size, in bytes, of the chunks read ahead by a background thread from the files compressed
+     *        as a single stream (zlib, zstd and lz4)
      */
-    GraphalyticsReader(const std::string& path_properties);
+    GraphalyticsReader(const std::string& path_properties, uint64_t num_threads = 1, uint64_t buffer_size = default_buffer_size());
 
     /**
      * Destructor
      */
     ~GraphalyticsReader();
 
+    /**
+     * Check whether the graph with the given property file is weighted, without opening its vertex & edge files
+     */
+    static bool is_weighted_graph(const std::string& path_properties);
+
+    /**
+     * Retrieve the given property from the property file, without opening the vertex & edge files of the graph.
+     * Return the empty string if the property is not present.
+     */
+    static std::string read_property(const std::string& path_properties, const std::string& key);
+
+    /**
+     * The default size of the chunks read ahead from the compressed input files, in bytes
+     */
+    static constexpr uint64_t default_buffer_size() { return (1ull << 22); } // 4 MB
+
     /**
      * Interface, report one edge at the time
      */
@@ -75,6 +109,18 @@ public:
      */
     bool read_vertex(uint64_t& out_vertex);
 
+    /**
+     * Read a batch of up to `capacity' edges from the graph, in columnar format. The weights are set to 0 when
+     * the graph is not weighted. Return the number of edges read, or 0 when the edge list has been depleted.
+     */
+    uint64_t read_edges(uint64_t* out_sources, uint64_t* out_destinations, double* out_weights, uint64_t capacity);
+
+    /**
+     * Read a batch of up to `capacity' vertices from the graph. Return the number of vertices read, or 0 when the
+     * vertex list has been depleted.
+     */
+    uint64_t read_vertices(uint64_t* out_vertices, uint64_t capacity);
+
     /**
      * Reset the position of the iterators read/read_edge/read_vertex at the start of the file
      */
@@ -0,0 +1,239 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "input_cache.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "lib/common/error.hpp"
+
+using namespace std;
+
+/*****************************************************************************
+ *                                                                           *
+ *  File format                                                              *
+ *                                                                           *
+ *****************************************************************************/
+namespace {
+
+// Size and last modification time of a file, to detect whether the cache is stale
+struct FileStamp {
+    uint64_t m_size;
+    int64_t m_mtime_sec;
+    int64_t m_mtime_nsec;
+
+    bool operator==(const FileStamp& other) const {
+        return m_size == other.m_size && m_mtime_sec == other.m_mtime_sec && m_mtime_nsec == other.m_mtime_nsec;
+    }
+};
+
+// The first bytes of the cache file. The paths of the vertex & edge files follow the header, then the arrays of
+// the vertices, of the degrees and of the edges, each aligned to a cache line.
+struct Header {
+    char m_magic[8]; // "GLCACHE"
+    uint64_t m_version; // format version
+    uint64_t m_sizeof_edge; // the size of each edge, either sizeof(Edge) or sizeof(WeightedEdge)
+    FileStamp m_stamps[3]; // the property file, the vertex file and the edge file
+    uint64_t m_path_vertex_file_sz; // length of the path to the vertex file, in bytes
+    uint64_t m_path_edge_file_sz; // length of the path to the edge file, in bytes
+    uint64_t m_num_vertices_property; // number of vertices stated in the property file
+    uint64_t m_num_edges_property; // number of edges stated in the property file
+    uint64_t m_num_vertices; // number of vertices in the cache
+    uint64_t m_num_edges; // number of edges in the cache
+    uint64_t m_offset_vertices; // offset of the array of vertices, in bytes
+    uint64_t m_offset_degrees; // offset of the array of degrees, in bytes
+    uint64_t m_offset_edges; // offset of the array of edges, in bytes
+};
+
+constexpr char CACHE_MAGIC[8] = { 'G', 'L', 'C', 'A', 'C', 'H', 'E', '\0' };
+constexpr uint64_t CACHE_VERSION = 2;
+constexpr uint64_t CACHE_ALIGNMENT = 64;
+
+// Round the given offset to the next multiple of CACHE_ALIGNMENT
+uint64_t align(uint64_t offset){
+    return (offset + CACHE_ALIGNMENT -1) / CACHE_ALIGNMENT * CACHE_ALIGNMENT;
+}
+
+// Retrieve the size and the last modification time of the given file. Return false if the file does not exist.
+bool get_file_stamp(const string& path, FileStamp* out_stamp){
+    struct stat info;
+    if(stat(path.c_str(), &info) != 0) return false;
+    out_stamp->m_size = info.st_size;
+    out_stamp->m_mtime_sec = info.st_mtim.tv_sec;
+    out_stamp->m_mtime_nsec = info.st_mtim.tv_nsec;
+    return true;
+}
+
+} // anonymous namespace
+
+/*****************************************************************************
+ *                                                                           *
+ *  Init                                                                     *
+ *                                                                           *
+ *****************************************************************************/
+
+InputCache::InputCache(){ }
+
+InputCache::~InputCache(){
+    unload();
+}
+
+string InputCache::path(const std::string& path_input_graph){
+    return path_input_graph + ".cache";
+}
+
+void InputCache::unload(){
+    if(m_mapping != nullptr){
+        munmap(m_mapping, m_mapping_sz); // ignore rc
+        m_mapping = nullptr;
+        m_mapping_sz = 0;
+    }
+    m_num_vertices_property = m_num_edges_property = m_num_vertices = m_num_edges = 0;
+    m_vertices = nullptr;
+    m_degrees = nullptr;
+    m_edges = nullptr;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Load                                                                     *
+ *                                                                           *
+ *****************************************************************************/
+
+bool InputCache::load0(const std::string& path_input_graph, uint64_t sizeof_edge){
+    string path_cache = path(path_input_graph);
+    int fd = open(path_cache.c_str(), O_RDONLY);
+    if(fd < 0) return false; // the cache does not exist
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < sizeof(Header)){ close(fd); return false; }
+    uint64_t mapping_sz = info.st_size;
+    void* mapping = mmap(nullptr, mapping_sz, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping is still valid
+    if(mapping == MAP_FAILED) ERROR("Cannot memory map the cache `" << path_cache << "': " << strerror(errno));
+
+    const char* content = reinterpret_cast<const char*>(mapping);
+    const Header* header = reinterpret_cast<const Header*>(content);
+    uint64_t offset_paths_end = sizeof(Header) + header->m_path_vertex_file_sz + header->m_path_edge_file_sz;
+    bool valid = memcmp(header->m_magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+            header->m_version == CACHE_VERSION &&
+            header->m_sizeof_edge == sizeof_edge &&
+            offset_paths_end <= header->m_offset_vertices &&
+            header->m_offset_vertices + header->m_num_vertices * sizeof(uint64_t) <= header->m_offset_degrees &&
+            header->m_offset_degrees + header->m_num_vertices * sizeof(uint32_t) <= header->m_offset_edges &&
+            header->m_offset_edges + header->m_num_edges * sizeof_edge <= mapping_sz;
+
+    // check the input files have not been altered since the cache was created
+    if(valid){
+        string path_vertex_file { content + sizeof(Header), header->m_path_vertex_file_sz };
+        string path_edge_file { content + sizeof(Header) + header->m_path_vertex_file_sz, header->m_path_edge_file_sz };
+        const string* paths[3] = { &path_input_graph, &path_vertex_file, &path_edge_file };
+        for(uint64_t i = 0; i < 3 && valid; i++){
+            FileStamp stamp;
+            valid = get_file_stamp(*(paths[i]), &stamp) && stamp == header->m_stamps[i];
+        }
+    }
+
+    if(!valid){ // stale
+        munmap(mapping, mapping_sz);
+        return false;
+    }
+
+    unload();
+    m_mapping = mapping;
+    m_mapping_sz = mapping_sz;
+    m_num_vertices_property = header->m_num_vertices_property;
+    m_num_edges_property = header->m_num_edges_property;
+    m_num_vertices = header->m_num_vertices;
+    m_num_edges = header->m_num_edges;
+    m_vertices = reinterpret_cast<const uint64_t*>(content + header->m_offset_vertices);
+    m_degrees = reinterpret_cast<const uint32_t*>(content + header->m_offset_degrees);
+    m_edges = content + header->m_offset_edges;
+    madvise(m_mapping, m_mapping_sz, MADV_SEQUENTIAL); // ignore rc, the arrays are scanned once
+
+    return true;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Store                                                                    *
+ *                                                                           *
+ *****************************************************************************/
+
+void InputCache::store0(const std::string& path_input_graph, const std::string& path_vertex_file, const std::string& path_edge_file,
+        uint64_t num_vertices_property, uint64_t num_edges_property, const uint64_t* vertices, const uint32_t* degrees, uint64_t num_vertices,
+        const void* edges, uint64_t sizeof_edge, uint64_t num_edges){
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.m_version = CACHE_VERSION;
+    header.m_sizeof_edge = sizeof_edge;
+    const string* paths[3] = { &path_input_graph, &path_vertex_file, &path_edge_file };
+    for(uint64_t i = 0; i < 3; i++){
+        if(!get_file_stamp(*(paths[i]), &(header.m_stamps[i]))) ERROR("Cannot retrieve the attributes of the file `" << *(paths[i]) << "'");
+    }
+    header.m_path_vertex_file_sz = path_vertex_file.size();
+    header.m_path_edge_file_sz = path_edge_file.size();
+    header.m_num_vertices_property = num_vertices_property;
+    header.m_num_edges_property = num_edges_property;
+    header.m_num_vertices = num_vertices;
+    header.m_num_edges = num_edges;
+    header.m_offset_vertices = align(sizeof(Header) + path_vertex_file.size() + path_edge_file.size());
+    header.m_offset_degrees = align(header.m_offset_vertices + num_vertices * sizeof(uint64_t));
+    header.m_offset_edges = align(header.m_offset_degrees + num_vertices * sizeof(uint32_t));
+
+    string path_cache = path(path_input_graph);
+    string path_tmp = path_cache + ".tmp." + to_string(getpid());
+    fstream handle(path_tmp, ios_base::out | ios_base::binary | ios_base::trunc);
+    if(!handle.good()) ERROR("Cannot open the file `" << path_tmp << "' for writing");
+
+    const char padding[CACHE_ALIGNMENT] = {0};
+    auto pad_to = [&](uint64_t offset){
+        uint64_t position = handle.tellp();
+        assert(position <= offset);
+        handle.write(padding, offset - position);
+    };
+
+    handle.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    handle.write(path_vertex_file.data(), path_vertex_file.size());
+    handle.write(path_edge_file.data(), path_edge_file.size());
+    pad_to(header.m_offset_vertices);
+    handle.write(reinterpret_cast<const char*>(vertices), num_vertices * sizeof(uint64_t));
+    pad_to(header.m_offset_degrees);
+    handle.write(reinterpret_cast<const char*>(degrees), num_vertices * sizeof(uint32_t));
+    pad_to(header.m_offset_edges);
+    handle.write(reinterpret_cast<const char*>(edges), num_edges * sizeof_edge);
+    handle.close();
+    if(!handle.good()){
+        unlink(path_tmp.c_str()); // ignore rc
+        ERROR("Cannot write the cache `" << path_tmp << "'");
+    }
+
+    if(rename(path_tmp.c_str(), path_cache.c_str()) != 0){
+        int error = errno;
+        unlink(path_tmp.c_str()); // ignore rc
+        ERROR("Cannot rename the cache `" << path_tmp << "' into `" << path_cache << "': " << strerror(error));
+    }
+}
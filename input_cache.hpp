@@ -0,0 +1,114 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Persistent cache of an input graph, already parsed and remapped to the dense vertex IDs used by the generator.
+ * The cache is a binary file stored next to the property file of the graph, `<graph>.properties.cache', and it is
+ * memory mapped when loaded. It becomes stale as soon as the size or the last modification time of the property file,
+ * the vertex file or the edge file change.
+ */
+class InputCache {
+    void* m_mapping { nullptr }; // the content of the cache file, memory mapped
+    uint64_t m_mapping_sz { 0 }; // the size of the mapping, in bytes
+    uint64_t m_num_vertices_property { 0 }; // the number of vertices stated in the property file (meta.vertices)
+    uint64_t m_num_edges_property { 0 }; // the number of edges stated in the property file (meta.edges)
+    uint64_t m_num_vertices { 0 }; // the number of vertices actually read from the vertex file
+    uint64_t m_num_edges { 0 }; // the number of edges actually read from the edge file
+    const uint64_t* m_vertices { nullptr }; // the external vertex IDs, indexed by their dense ID
+    const uint32_t* m_degrees { nullptr }; // the number of edges attached to each vertex, indexed by its dense ID
+    const void* m_edges { nullptr }; // the edges of the graph, with the endpoints remapped to the dense IDs
+
+    // Release the mapping
+    void unload();
+
+    // Implementation of #load and #store, for edges of `sizeof_edge' bytes
+    bool load0(const std::string& path_input_graph, uint64_t sizeof_edge);
+    static void store0(const std::string& path_input_graph, const std::string& path_vertex_file, const std::string& path_edge_file,
+            uint64_t num_vertices_property, uint64_t num_edges_property, const uint64_t* vertices, const uint32_t* degrees, uint64_t num_vertices,
+            const void* edges, uint64_t sizeof_edge, uint64_t num_edges);
+
+public:
+    // Create an empty instance
+    InputCache();
+
+    // Destructor
+    ~InputCache();
+
+    InputCache(const InputCache&) = delete;
+    InputCache& operator=(const InputCache&) = delete;
+
+    /**
+     * The path of the cache file for the given input graph
+     */
+    static std::string path(const std::string& path_input_graph);
+
+    /**
+     * Memory map the cache of the given input graph (path to the .properties file). Return false, without altering
+     * the instance, if the cache does not exist, it is stale, or it stores a different type of edges than E.
+     */
+    template<typename E>
+    bool load(const std::string& path_input_graph) { return load0(path_input_graph, sizeof(E)); }
+
+    /**
+     * Save the parsed input graph in its cache file. The file is first written with a temporary name and then renamed,
+     * so that concurrent runs never observe a partial cache.
+     * @param path_input_graph the path to the .properties file of the graph
+     * @param path_vertex_file the path to the vertex file of the graph
+     * @param path_edge_file the path to the edge file of the graph
+     * @param num_vertices_property the number of vertices stated in the property file
+     * @param num_edges_property the number of edges stated in the property file
+     * @param vertices the external vertex IDs, indexed by their dense ID
+     * @param degrees the number of edges attached to each vertex, indexed by its dense ID
+     * @param num_vertices the number of vertices in the arrays `vertices' and `degrees'
+     * @param edges the edges of the graph, with the endpoints remapped to the dense IDs
+     * @param num_edges the number of edges in the array `edges'
+     */
+    template<typename E>
+    static void store(const std::string& path_input_graph, const std::string& path_vertex_file, const std::string& path_edge_file,
+            uint64_t num_vertices_property, uint64_t num_edges_property, const uint64_t* vertices, const uint32_t* degrees, uint64_t num_vertices,
+            const E* edges, uint64_t num_edges){
+        store0(path_input_graph, path_vertex_file, path_edge_file, num_vertices_property, num_edges_property, vertices, degrees, num_vertices,
+                edges, sizeof(E), num_edges);
+    }
+
+    // The number of vertices stated in the property file
+    uint64_t num_vertices_property() const { return m_num_vertices_property; }
+
+    // The number of edges stated in the property file
+    uint64_t num_edges_property() const { return m_num_edges_property; }
+
+    // The number of vertices stored in the cache
+    uint64_t num_vertices() const { return m_num_vertices; }
+
+    // The number of edges stored in the cache
+    uint64_t num_edges() const { return m_num_edges; }
+
+    // The external vertex IDs, indexed by their dense ID
+    const uint64_t* vertices() const { return m_vertices; }
+
+    // The degree of each vertex, indexed by its dense ID
+    const uint32_t* degrees() const { return m_degrees; }
+
+    // The edges of the graph, with the endpoints remapped to the dense IDs. The type E must be the same given to #load
+    template<typename E>
+    const E* edges() const { return reinterpret_cast<const E*>(m_edges); }
+};
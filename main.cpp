@@ -15,19 +15,27 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <iostream>
 #include <mutex>
 #include <random>
+#include <sstream>
 #include <string>
 
+#include "lib/common/cpu_topology.hpp"
 #include "lib/common/error.hpp"
 #include "lib/common/filesystem.hpp"
+#include "lib/common/quantity.hpp"
 #include "lib/common/system.hpp"
 #include "lib/common/timer.hpp"
 #include "lib/cxxopts.hpp"
 
 #include "generator.hpp"
+#include "graphalytics_reader.hpp"
+#include "memory_planner.hpp"
+#include "statistics.hpp"
 #include "writer.hpp"
 
 using namespace common;
@@ -40,6 +48,9 @@ double g_ef_vertices = 1.2; // expansion factor for the vertices in the graph
 string g_path_input; // path to the input graph, in the Graphalytics format
 string g_path_output; // path where to store the log of updates
 uint64_t g_seed = std::random_device{}(); // the seed to use for the random generator
+GeneratorOptions g_generator_options; // the data structures of the generator and the threads for its initialisation
+uint64_t g_memory_limit = 0; // if not 0, the memory budget to plan the data structures of the generator, in bytes
+string g_path_stats_json; // if not empty, where to save the resources used by each phase, in JSON
 
 // logging
 mutex g_mutex_log;
@@ -47,6 +58,15 @@ mutex g_mutex_log;
 // function prototypes
 static void parse_command_line_arguments(int argc, char* argv[]);
 static uint64_t num_operations(); // total number of operations to produce
+static uint64_t parse_memory_size(const string& value); // parse a quantity of bytes, such as 512M or 16G
+static EdgeOrder parse_edge_order(const string& value); // parse the argument of --edge-order
+static TemporaryEdgesStore parse_temporary_edges(const string& value); // parse the argument of --temporary-edges
+static VertexSamplerType parse_vertex_sampler(const string& value); // parse the argument of --vertex-sampler
+static string to_string(EdgeOrder value); // the name of the option in the command line
+static string to_string(TemporaryEdgesStore value); // the name of the option in the command line
+static string to_string(VertexSamplerType value); // the name of the option in the command line
+template<typename WeightPolicy> static void plan_memory(Writer& writer); // fit the generator into g_memory_limit
+template<typename WeightPolicy> static void run_generator(Writer& writer); // create the log of updates
 
 
 int main(int argc, char* argv[]) {
@@ -54,6 +74,18 @@ int main(int argc, char* argv[]) {
 
     try {
         parse_command_line_arguments(argc, argv);
+        Statistics::Phase phase_stats { "total" };
+        Statistics::set_property("aging_coeff", to_string(g_aging));
+        Statistics::set_property("ef_edges", to_string(g_ef_edges));
+        Statistics::set_property("ef_vertices", to_string(g_ef_vertices));
+        Statistics::set_property("git_last_commit", common::git_last_commit());
+        Statistics::set_property("hostname", common::hostname());
+        Statistics::set_property("input_graph", g_path_input);
+        Statistics::set_property("seed", to_string(g_seed));
+        Statistics::set_property("edge_order", to_string(g_generator_options.m_edge_order));
+        Statistics::set_property("temporary_edges", to_string(g_generator_options.m_temporary_edges));
+        Statistics::set_property("vertex_sampler", to_string(g_generator_options.m_vertex_sampler));
+        Statistics::set_property("init_threads", to_string(g_generator_options.m_init_threads));
 
         Writer writer;
         writer.set_property("aging_coeff", g_aging);
@@ -64,8 +96,17 @@ int main(int argc, char* argv[]) {
         writer.set_property("input_graph", g_path_input);
         writer.set_property("seed", g_seed);
 
-        Generator generator {g_path_input, g_path_output, writer, 1.0, g_ef_vertices, g_ef_edges, g_aging, g_seed};
-        generator.generate();
+        if(GraphalyticsReader::is_weighted_graph(g_path_input)){
+            run_generator<EdgeWeighted>(writer);
+        } else { // only store the endpoints of the edges
+            run_generator<EdgeUnweighted>(writer);
+        }
+
+        phase_stats.stop();
+        if(!g_path_stats_json.empty()){
+            Statistics::save(g_path_stats_json);
+            cout << "Statistics saved in: " << g_path_stats_json << "\n";
+        }
     } catch (common::Error& e){
         cerr << e << endl;
         cerr << "Type `" << argv[0] << " --help' to check how to run the program\n";
@@ -78,18 +119,78 @@ int main(int argc, char* argv[]) {
     return 0;
 }
 
+template<typename WeightPolicy>
+static void plan_memory(Writer& writer){
+    using edge_t = typename WeightPolicy::edge_t;
+    string prop_num_vertices = GraphalyticsReader::read_property(g_path_input, "meta.vertices");
+    string prop_num_edges = GraphalyticsReader::read_property(g_path_input, "meta.edges");
+    if(prop_num_vertices.empty() || prop_num_edges.empty()){
+        ERROR("Cannot plan the memory footprint, the properties `meta.vertices' and `meta.edges' are not set in the input graph: " << g_path_input);
+    }
+    MemoryPlanner planner { stoull(prop_num_vertices), stoull(prop_num_edges), g_ef_vertices, g_ef_edges, g_aging };
+
+    MemoryPlanner::Config config;
+    config.m_sizeof_edge = sizeof(edge_t);
+    config.m_block_capacity = Generator<WeightPolicy>::num_final_edges_per_block();
+    config.m_num_threads = g_generator_options.m_init_threads;
+    config.m_edge_order_feistel = (g_generator_options.m_edge_order == EdgeOrder::FEISTEL);
+    config.m_input_cache = g_generator_options.m_input_cache;
+    config.m_spill_edges = !g_generator_options.m_scratch_directory.empty();
+    config.m_temporary_edges_abtree = (g_generator_options.m_temporary_edges == TemporaryEdgesStore::ABTREE);
+    config.m_vertex_sampler_alias = (g_generator_options.m_vertex_sampler == VertexSamplerType::ALIAS);
+    config.m_vertex_sampler_buckets = (g_generator_options.m_vertex_sampler == VertexSamplerType::DEGREE_BUCKETS);
+    config.m_writer_block_size = Writer::edges_block_size();
+    config.m_writer_block_capacity = Writer::num_edges_per_block();
+    config.m_writer_queue_sz = writer.max_pending_compressions();
+    config.m_writer_threads = writer.num_compression_threads();
+
+    if(!planner.fit(g_memory_limit, config)){ // report the footprint of the smallest configuration
+        stringstream ss;
+        planner.estimate(config).dump(ss);
+        ERROR("The memory limit of " << ComputerQuantity(g_memory_limit) << "B is too small for the input graph and the expansion factors given. " << ss.str());
+    }
+
+    string& scratch_directory = g_generator_options.m_scratch_directory;
+    if(config.m_spill_edges && scratch_directory.empty()){ // keep the final edges next to the output log
+        size_t pos = g_path_output.find_last_of('/');
+        scratch_directory = (pos == string::npos) ? "." : (pos == 0 ? "/" : g_path_output.substr(0, pos));
+        cout << "The final edges do not fit the memory limit, they will be kept in the scratch directory: " << scratch_directory << "\n";
+    }
+    writer.set_max_pending_compressions(config.m_writer_queue_sz);
+
+    planner.estimate(config).dump(cout);
+    cout << "Max number of blocks pending compression: " << config.m_writer_queue_sz << "\n" << endl;
+}
+
+template<typename WeightPolicy>
+static void run_generator(Writer& writer){
+    if(g_memory_limit > 0){ plan_memory<WeightPolicy>(writer); }
+
+    Generator<WeightPolicy> generator {g_path_input, g_path_output, writer, g_generator_options, 1.0, g_ef_vertices, g_ef_edges, g_aging, g_seed};
+    generator.generate();
+}
 
 static void parse_command_line_arguments(int argc, char* argv[]){
     using namespace cxxopts;
+    g_generator_options.m_init_threads = std::max<uint64_t>(1, cpu_topology().get_threads(false, false).size());
 
     Options options(argv[0], "Graph Generator of Updates (graphlog): create a log of edge updates based on the distribution of the input graph");
     options.custom_help(" [options] <input> <output>");
     options.add_options()
         ("a, aging", "Number of operations to produce w.r.t. the size of the loaded graph", value<double>()->default_value(to_string(g_aging)))
+        ("cache", "Load the input graph from a binary cache stored next to its property file. The cache is (re)created when missing or when the input files change")
+        ("edge-order", "How to randomise the order the final edges are inserted: `shuffle' permutes the edges at startup, `feistel' visits them on demand through a keyed bijection, without copying them", value<string>()->default_value(to_string(g_generator_options.m_edge_order)))
         ("e, efe", "Expansion factor for the edges in the graph", value<double>()->default_value(to_string(g_ef_edges)))
         ("v, efv", "Expansion factor for the vertices in the graph", value<double>()->default_value(to_string(g_ef_vertices)))
         ("h, help", "Show this help menu")
+        ("init-threads", "Number of threads for the initialisation: parse or decompress the input graph, sort its vertices, build the counting tree and shuffle its edges. The operations are generated by a single thread", value<uint64_t>()->default_value(to_string(g_generator_options.m_init_threads)))
+        ("memory-limit", "Max amount of memory to use, e.g. 16G. The footprint is estimated upfront: the queue of the writer is shrunk and the final edges are spilled to the scratch directory, or to the directory of the output log, to stay within the limit. The program fails immediately when the limit cannot be met", value<string>())
+        ("reader-buffer-size", "Size of the chunks read ahead from the compressed input files, in bytes", value<uint64_t>()->default_value(to_string(g_generator_options.m_reader_buffer_size)))
+        ("scratch-dir", "Keep the final edges in temporary files in the given directory rather than in memory, for graphs larger than the main memory", value<string>())
         ("seed", "Seed to initialise the random generator", value<uint64_t>())
+        ("stats-json", "Save the wall time, CPU time, memory, page faults and I/O of each phase, and the counters of the generation, in the given JSON file", value<string>())
+        ("temporary-edges", "How to store the temporary edges during the generation: `vector' keeps them in a dense array, `abtree' indexes them by a random key in an (a,b)-tree, as the previous versions. With --vertex-sampler counting-tree, the latter reproduces the logs of the versions that already shuffled the final edges on load and sorted the vertices with parallel_sort, not of those that permuted the final edges at startup", value<string>()->default_value(to_string(g_generator_options.m_temporary_edges)))
+        ("vertex-sampler", "How to draw the endpoints of the temporary edges in proportion to the frequencies of the vertices: `alias' through a static alias table, in constant time, `degree-buckets' through an alias table over the distinct frequencies and a uniform draw among the vertices with the same frequency, in constant time and with a smaller footprint, `counting-tree' through a counting tree, in logarithmic time, as the previous versions. See --temporary-edges for the logs that can be reproduced", value<string>()->default_value(to_string(g_generator_options.m_vertex_sampler)))
     ;
 
     auto parsed_args = options.parse(argc, argv);
@@ -132,15 +233,152 @@ static void parse_command_line_arguments(int argc, char* argv[]){
         g_ef_edges = value;
     }
 
+    if(parsed_args.count("init-threads") > 0){
+        uint64_t value = parsed_args["init-threads"].as<uint64_t>();
+        if(value < 1){
+            INVALID_ARGUMENT("The number of threads for the initialisation must be a value equal or greater than 1: " << value);
+        }
+        g_generator_options.m_init_threads = value;
+    }
+
+    if(parsed_args.count("reader-buffer-size") > 0){
+        uint64_t value = parsed_args["reader-buffer-size"].as<uint64_t>();
+        if(value < 4096){
+            INVALID_ARGUMENT("The size of the reader buffers must be a value equal or greater than 4096 bytes: " << value);
+        }
+        g_generator_options.m_reader_buffer_size = value;
+    }
+
+    if(parsed_args.count("cache") > 0){
+        g_generator_options.m_input_cache = true;
+    }
+
+    if(parsed_args.count("edge-order") > 0){
+        g_generator_options.m_edge_order = parse_edge_order(parsed_args["edge-order"].as<string>());
+    }
+
+    if(parsed_args.count("scratch-dir") > 0){
+        string value = parsed_args["scratch-dir"].as<string>();
+        if(value.empty()){
+            INVALID_ARGUMENT("The path to the scratch directory is empty");
+        }
+        if(g_generator_options.m_edge_order == EdgeOrder::FEISTEL){
+            INVALID_ARGUMENT("The option --scratch-dir is not supported with --edge-order feistel, the final edges are accessed randomly");
+        }
+        g_generator_options.m_scratch_directory = value;
+    }
+
+    if(parsed_args.count("temporary-edges") > 0){
+        g_generator_options.m_temporary_edges = parse_temporary_edges(parsed_args["temporary-edges"].as<string>());
+    }
+
+    if(parsed_args.count("vertex-sampler") > 0){
+        g_generator_options.m_vertex_sampler = parse_vertex_sampler(parsed_args["vertex-sampler"].as<string>());
+    }
+
+    if(parsed_args.count("memory-limit") > 0){
+        g_memory_limit = parse_memory_size(parsed_args["memory-limit"].as<string>());
+        if(g_memory_limit == 0){
+            INVALID_ARGUMENT("The memory limit must be greater than 0");
+        }
+    }
+
     if(parsed_args.count("seed") > 0){
         g_seed = parsed_args["seed"].as<uint64_t>();
     }
 
+    if(parsed_args.count("stats-json") > 0){
+        g_path_stats_json = parsed_args["stats-json"].as<string>();
+    }
+
     cout << "Path input graph: " << g_path_input << "\n";
     cout << "Path output log: " << g_path_output << "\n";
     cout << "Aging factor: " << g_aging << "\n";
     cout << "Expansion factor for the vertices: " << g_ef_vertices << "\n";
     cout << "Expansion factor for the edges: " << g_ef_edges << "\n";
     cout << "Seed for the random generator: " << g_seed << "\n";
+    cout << "Number of threads for the initialisation: " << g_generator_options.m_init_threads << "\n";
+    cout << "Size of the read ahead buffers for the compressed input graph: " << ComputerQuantity(g_generator_options.m_reader_buffer_size) << "B\n";
+    cout << "Cache of the input graph: " << (g_generator_options.m_input_cache ? "yes" : "no") << "\n";
+    cout << "Order of the final edges: " << to_string(g_generator_options.m_edge_order) << "\n";
+    cout << "Store of the temporary edges: " << to_string(g_generator_options.m_temporary_edges) << "\n";
+    cout << "Sampler of the vertices: " << to_string(g_generator_options.m_vertex_sampler) << "\n";
+    cout << "Scratch directory for the final edges: " << (g_generator_options.m_scratch_directory.empty() ? "none, in memory" : g_generator_options.m_scratch_directory) << "\n";
+    if(g_memory_limit > 0){
+        cout << "Memory limit: " << ComputerQuantity(g_memory_limit) << "B\n";
+    } else {
+        cout << "Memory limit: none\n";
+    }
+    cout << "Statistics: " << (g_path_stats_json.empty() ? "none" : g_path_stats_json) << "\n";
     cout << endl;
+}
+
+static uint64_t parse_memory_size(const string& value){
+    size_t pos = 0;
+    double magnitude = 0;
+    try {
+        magnitude = stod(value, &pos);
+    } catch(std::logic_error&){
+        INVALID_ARGUMENT("Invalid amount of memory: `" << value << "'");
+    }
+    if(magnitude < 0){ INVALID_ARGUMENT("Invalid amount of memory: `" << value << "'"); }
+
+    // optional unit, in multiples of 1024, followed by an optional `B' or `iB'
+    string unit;
+    for(; pos < value.size(); pos++){ if(!isspace(static_cast<unsigned char>(value[pos]))) unit += toupper(static_cast<unsigned char>(value[pos])); }
+    if(unit.size() >= 2 && unit.compare(unit.size() -2, 2, "IB") == 0){ unit.resize(unit.size() -2); }
+    else if(!unit.empty() && unit.back() == 'B'){ unit.pop_back(); }
+
+    double multiplier = 1;
+    if(unit == "K"){ multiplier = 1ull << 10; }
+    else if(unit == "M"){ multiplier = 1ull << 20; }
+    else if(unit == "G"){ multiplier = 1ull << 30; }
+    else if(unit == "T"){ multiplier = 1ull << 40; }
+    else if(!unit.empty()){ INVALID_ARGUMENT("Invalid unit for the amount of memory: `" << value << "'. Expected K, M, G or T"); }
+
+    return static_cast<uint64_t>(magnitude * multiplier);
+}
+
+static EdgeOrder parse_edge_order(const string& value){
+    if(value == "shuffle"){ return EdgeOrder::SHUFFLE; }
+    else if(value == "feistel"){ return EdgeOrder::FEISTEL; }
+    else { INVALID_ARGUMENT("Invalid order for the final edges: `" << value << "'. Expected either `shuffle' or `feistel'"); }
+}
+
+static TemporaryEdgesStore parse_temporary_edges(const string& value){
+    if(value == "vector"){ return TemporaryEdgesStore::VECTOR; }
+    else if(value == "abtree"){ return TemporaryEdgesStore::ABTREE; }
+    else { INVALID_ARGUMENT("Invalid store for the temporary edges: `" << value << "'. Expected either `vector' or `abtree'"); }
+}
+
+static VertexSamplerType parse_vertex_sampler(const string& value){
+    if(value == "alias"){ return VertexSamplerType::ALIAS; }
+    else if(value == "degree-buckets"){ return VertexSamplerType::DEGREE_BUCKETS; }
+    else if(value == "counting-tree"){ return VertexSamplerType::COUNTING_TREE; }
+    else { INVALID_ARGUMENT("Invalid sampler for the vertices: `" << value << "'. Expected either `alias', `degree-buckets' or `counting-tree'"); }
+}
+
+static string to_string(EdgeOrder value){
+    switch(value){
+    case EdgeOrder::SHUFFLE: return "shuffle";
+    case EdgeOrder::FEISTEL: return "feistel";
+    default: return "unknown";
+    }
+}
+
+static string to_string(TemporaryEdgesStore value){
+    switch(value){
+    case TemporaryEdgesStore::VECTOR: return "vector";
+    case TemporaryEdgesStore::ABTREE: return "abtree";
+    default: return "unknown";
+    }
+}
+
+static string to_string(VertexSamplerType value){
+    switch(value){
+    case VertexSamplerType::ALIAS: return "alias";
+    case VertexSamplerType::DEGREE_BUCKETS: return "degree-buckets";
+    case VertexSamplerType::COUNTING_TREE: return "counting-tree";
+    default: return "unknown";
+    }
 }
\ No newline at end of file
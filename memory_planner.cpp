@@ -0,0 +1,167 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "memory_planner.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "lib/common/quantity.hpp"
+#include "edge.hpp"
+#include "edge_map.hpp"
+#include "edge_shuffle.hpp"
+
+using namespace common;
+using namespace std;
+
+/*****************************************************************************
+ *                                                                           *
+ *  Footprint                                                                *
+ *                                                                           *
+ *****************************************************************************/
+namespace {
+
+// Bytes for each entry of the ABTree<uint64_t, Edge> with the temporary edges: a key and a value, with the leaves
+// about two thirds full
+constexpr uint64_t temporary_edges_bytes_per_entry = 24;
+
+// Bytes for each entry of the counting tree: a leaf and its share of the inner nodes
+constexpr double counting_tree_bytes_per_entry = sizeof(int64_t) * 64.0 / 63.0;
+
+// Bytes for each entry of the alias table: the column, with a threshold and an alias
+constexpr uint64_t alias_table_bytes_per_entry = 2 * sizeof(uint64_t);
+
+// Bytes for each entry of the scratch arrays to build the alias table: the weight, the residual and the worklist
+constexpr uint64_t alias_table_build_bytes_per_entry = sizeof(int64_t) + 2 * sizeof(uint64_t) + sizeof(uint64_t);
+
+} // anonymous namespace
+
+uint64_t MemoryPlanner::Footprint::init() const {
+    return m_vertices + m_vertices_init + m_vertex_sampler + m_edges_final_init;
+}
+
+uint64_t MemoryPlanner::Footprint::generation() const {
+    return m_vertices + m_vertex_sampler + m_edges_final + m_edges_stored + m_temporary_edges + m_writer;
+}
+
+uint64_t MemoryPlanner::Footprint::peak() const {
+    return std::max(init(), generation());
+}
+
+void MemoryPlanner::Footprint::dump(std::ostream& out) const {
+    out << "Estimated memory footprint: " << ComputerQuantity(peak()) << "B\n";
+    out << "  loading the input graph: " << ComputerQuantity(init()) << "B (vertices: " << ComputerQuantity(m_vertices + m_vertices_init) << "B, "
+            "vertex sampler: " << ComputerQuantity(m_vertex_sampler) << "B, final edges: " << ComputerQuantity(m_edges_final_init) << "B)\n";
+    out << "  generating the updates: " << ComputerQuantity(generation()) << "B (vertices: " << ComputerQuantity(m_vertices) << "B, "
+            "vertex sampler: " << ComputerQuantity(m_vertex_sampler) << "B, final edges: " << ComputerQuantity(m_edges_final) << "B, "
+            "edges stored: " << ComputerQuantity(m_edges_stored) << "B, temporary edges: " << ComputerQuantity(m_temporary_edges) << "B, "
+            "writer: " << ComputerQuantity(m_writer) << "B)\n";
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Planner                                                                  *
+ *                                                                           *
+ *****************************************************************************/
+
+MemoryPlanner::MemoryPlanner(uint64_t num_vertices, uint64_t num_edges, double ef_vertices, double ef_edges, double aging_factor) :
+    m_num_vertices_final(num_vertices), m_num_vertices(num_vertices + static_cast<uint64_t>(ceil((ef_vertices - 1.0) * num_vertices))),
+    m_num_edges_final(num_edges), m_num_max_edges(ef_edges * num_edges), m_num_operations(aging_factor * num_edges) {
+
+}
+
+MemoryPlanner::Footprint MemoryPlanner::estimate(const Config& config) const {
+    Footprint fp;
+    const uint64_t edges_sz = m_num_edges_final * config.m_sizeof_edge;
+    const uint64_t block_sz = std::min(config.m_block_capacity, m_num_edges_final) * config.m_sizeof_edge;
+    const uint64_t num_blocks = (m_num_edges_final + config.m_block_capacity -1) / std::max<uint64_t>(1, config.m_block_capacity);
+
+    // vertices
+    fp.m_vertices = m_num_vertices * sizeof(uint64_t);
+    uint64_t vertex_map_capacity = 16;
+    while(vertex_map_capacity < 2 * m_num_vertices_final){ vertex_map_capacity *= 2; }
+    fp.m_vertices_init = /* frequencies */ m_num_vertices * 2 * sizeof(uint32_t) + /* VertexMap */ vertex_map_capacity * 2 * sizeof(uint64_t);
+    if(config.m_vertex_sampler_alias){
+        fp.m_vertex_sampler = m_num_vertices * (alias_table_bytes_per_entry + alias_table_build_bytes_per_entry);
+    } else if(config.m_vertex_sampler_buckets){ // the positions grouped by bucket, the weights to build them, the buckets are negligible
+        fp.m_vertex_sampler = m_num_vertices * (sizeof(uint32_t) + sizeof(int64_t));
+    } else {
+        fp.m_vertex_sampler = static_cast<uint64_t>(m_num_vertices * counting_tree_bytes_per_entry) + /* bulk load */ m_num_vertices * sizeof(int64_t);
+    }
+
+    // final edges
+    fp.m_edges_final_init = (config.m_edge_order_feistel || config.m_input_cache) ? edges_sz : 0; // flat copy, in the order of the input
+    if(config.m_edge_order_feistel){
+        fp.m_edges_final = edges_sz;
+    } else {
+        uint64_t num_buckets = std::max<uint64_t>(1, num_blocks);
+        uint64_t num_threads = std::min(std::max<uint64_t>(1, config.m_num_threads), num_buckets);
+        if(config.m_spill_edges){
+            // the buffers of the buckets, then the bucket shuffled by each thread; two blocks read ahead
+            fp.m_edges_final_init += std::max(num_buckets * EdgeShuffle<Edge>::spill_buffer_capacity() * config.m_sizeof_edge, num_threads * block_sz);
+            fp.m_edges_final = 2 * block_sz;
+        } else {
+            // the buckets, then the blocks copied out of the buckets by each thread
+            fp.m_edges_final_init += edges_sz + num_threads * block_sz;
+            fp.m_edges_final = edges_sz;
+        }
+    }
+
+    // generation
+    fp.m_edges_stored = EdgeMap::capacity(std::max(m_num_max_edges, m_num_edges_final +1)) * /* key + value */ 2 * sizeof(uint64_t);
+    if(config.m_temporary_edges_abtree){
+        fp.m_temporary_edges = m_num_max_edges * temporary_edges_bytes_per_entry;
+    } else { // reserved upfront
+        fp.m_temporary_edges = std::max(m_num_max_edges, m_num_edges_final +1) * sizeof(Edge);
+    }
+    // the block being filled, the blocks queued, and for each compression thread its input and its compressed output,
+    // assumed to be at most half of the input. Only the pages written are resident, the whole log can be smaller than a block
+    uint64_t writer_num_blocks = 1 + config.m_writer_queue_sz + config.m_writer_threads;
+    uint64_t writer_log_sz = static_cast<double>(m_num_operations) / std::max<uint64_t>(1, config.m_writer_block_capacity) * config.m_writer_block_size;
+    fp.m_writer = std::min(writer_num_blocks * config.m_writer_block_size, writer_log_sz);
+    fp.m_writer += std::min(config.m_writer_threads * config.m_writer_block_size, writer_log_sz) / 2;
+
+    return fp;
+}
+
+bool MemoryPlanner::fit(uint64_t memory_limit, Config& config) const {
+    // spill the final edges only as a last resort, as it costs I/O
+    bool spill_options[2] = { config.m_spill_edges, true };
+    uint64_t num_spill_options = (config.m_spill_edges || config.m_edge_order_feistel) ? 1 : 2;
+
+    Config smallest = config;
+    uint64_t smallest_footprint = estimate(config).peak();
+    for(uint64_t i = 0; i < num_spill_options; i++){
+        for(uint64_t queue_sz = config.m_writer_queue_sz; queue_sz >= 1; queue_sz--){
+            Config candidate = config;
+            candidate.m_spill_edges = spill_options[i];
+            candidate.m_writer_queue_sz = queue_sz;
+            uint64_t footprint = estimate(candidate).peak();
+            if(footprint <= memory_limit){
+                config = candidate;
+                return true;
+            } else if(footprint < smallest_footprint){
+                smallest = candidate;
+                smallest_footprint = footprint;
+            }
+        }
+    }
+
+    config = smallest;
+    return false;
+}
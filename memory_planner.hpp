@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <iostream>
+
+/**
+ * Estimate the peak memory footprint of the generator before the input graph is loaded, from the number of vertices
+ * and edges stated in its property file, and adjust the configuration to fit a memory budget. Only the largest data
+ * structures are accounted: the vertices, the vertex sampler, the final edges, the hash table and the store of the
+ * temporary edges during the generation, and the buffers of the writer. The estimate is an approximation, the actual
+ * footprint also depends on the allocator and on the distribution of the graph.
+ *
+ * The capacity of the blocks of the final edges is only an input of the plan, it is never adjusted to fit the budget,
+ * even though in external memory mode it bounds the footprint of the second pass of the shuffle and of the blocks
+ * read ahead. The capacity determines the number of buckets of the EdgeShuffle, and then the order of the final
+ * edges: changing it would make the log depend on the memory limit.
+ */
+class MemoryPlanner {
+public:
+    // The settings affecting the memory footprint
+    struct Config {
+        uint64_t m_sizeof_edge; // size of each final edge, in bytes
+        uint64_t m_block_capacity; // number of final edges in each block
+        uint64_t m_num_threads; // number of threads for the initialisation, to parse, sort and shuffle the input graph
+        bool m_edge_order_feistel; // whether the final edges are visited through a bijection, with --edge-order feistel
+        bool m_input_cache; // whether the input graph is also stored in its cache, with --cache
+        bool m_spill_edges; // whether the final edges are kept in scratch files, with --scratch-dir
+        bool m_temporary_edges_abtree; // whether the temporary edges are kept in an (a,b)-tree, with --temporary-edges abtree
+        bool m_vertex_sampler_alias; // whether the vertices are drawn through an alias table, with --vertex-sampler alias
+        bool m_vertex_sampler_buckets; // whether the vertices are drawn through their buckets by frequency, with --vertex-sampler degree-buckets
+        uint64_t m_writer_block_size; // size of each uncompressed block of edges in the writer, in bytes
+        uint64_t m_writer_block_capacity; // number of edges in each block of the writer
+        uint64_t m_writer_queue_sz; // max number of blocks queued pending compression in the writer
+        uint64_t m_writer_threads; // number of compression threads in the writer
+    };
+
+    // The estimated footprint of each data structure, in bytes
+    struct Footprint {
+        uint64_t m_vertices; // the external IDs of the vertices
+        uint64_t m_vertices_init; // the frequencies of the vertices and the translation of their IDs, while loading
+        uint64_t m_vertex_sampler; // the counting tree, the alias table or the degree buckets, including the scratch arrays to build it
+        uint64_t m_edges_final_init; // the final edges, while they are loaded and shuffled
+        uint64_t m_edges_final; // the final edges, during the generation
+        uint64_t m_edges_stored; // the hash table of the edges in the graph, during the generation
+        uint64_t m_temporary_edges; // the store of the temporary edges, during the generation
+        uint64_t m_writer; // the buffers of the writer, during the generation
+
+        // Peak footprint while the input graph is loaded
+        uint64_t init() const;
+
+        // Peak footprint during the generation
+        uint64_t generation() const;
+
+        // Overall peak footprint
+        uint64_t peak() const;
+
+        // Dump the breakdown of the footprint to the given output stream
+        void dump(std::ostream& out = std::cout) const;
+    };
+
+private:
+    const uint64_t m_num_vertices_final; // number of vertices in the input graph
+    const uint64_t m_num_vertices; // number of vertices, including the temporary ones
+    const uint64_t m_num_edges_final; // number of edges in the input graph
+    const uint64_t m_num_max_edges; // max number of edges stored at the same time during the generation
+    const uint64_t m_num_operations; // number of operations to generate
+
+public:
+    /**
+     * Create a new instance
+     * @param num_vertices the number of vertices in the input graph
+     * @param num_edges the number of edges in the input graph
+     * @param ef_vertices the expansion factor for the vertices
+     * @param ef_edges the expansion factor for the edges
+     * @param aging_factor the number of operations to generate, w.r.t. the number of edges in the input graph
+     */
+    MemoryPlanner(uint64_t num_vertices, uint64_t num_edges, double ef_vertices, double ef_edges, double aging_factor);
+
+    /**
+     * Estimate the footprint of the generator with the given configuration
+     */
+    Footprint estimate(const Config& config) const;
+
+    /**
+     * Adjust the given configuration to fit the memory limit, in bytes. The queue of the writer is shrunk first,
+     * then the final edges are spilled to scratch files, when their order allows it. Return false if no configuration
+     * fits the limit, setting `config' to the configuration with the smallest footprint.
+     */
+    bool fit(uint64_t memory_limit, Config& config) const;
+};
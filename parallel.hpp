@@ -0,0 +1,88 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+/**
+ * Split the range [0, count) into `num_threads' contiguous partitions and invoke fn(start, end) for each of them, on
+ * its own thread. The first exception raised by any partition is propagated to the caller, after all threads terminate.
+ */
+template<typename Function>
+void parallel_for(uint64_t num_threads, uint64_t count, Function fn){
+    num_threads = std::max<uint64_t>(1, std::min(num_threads, count));
+    if(num_threads == 1){ fn(0, count); return; }
+
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(num_threads);
+    for(uint64_t i = 0; i < num_threads; i++){
+        threads.emplace_back([&, i](){
+            try {
+                fn(count * i / num_threads, count * (i +1) / num_threads);
+            } catch(...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for(auto& t : threads){ t.join(); }
+    for(auto& e : errors){ if(e) std::rethrow_exception(e); }
+}
+
+/**
+ * Sort the range [first, last) with up to `num_threads' threads. The range is split into `num_threads' partitions,
+ * sorted independently, and then merged pairwise. As std::sort, the sort is not stable: the order of equivalent
+ * elements may depend on the number of threads.
+ */
+template<typename RandomIt, typename Compare>
+void parallel_sort(uint64_t num_threads, RandomIt first, RandomIt last, Compare comp){
+    constexpr uint64_t min_partition_sz = (1ull << 16); // do not bother spawning threads for smaller partitions
+    uint64_t count = last - first;
+    num_threads = std::max<uint64_t>(1, std::min(num_threads, count / min_partition_sz));
+    if(num_threads == 1){ std::sort(first, last, comp); return; }
+
+    std::vector<uint64_t> bounds(num_threads +1);
+    for(uint64_t i = 0; i <= num_threads; i++){ bounds[i] = count * i / num_threads; }
+
+    parallel_for(num_threads, num_threads, [&](uint64_t start, uint64_t end){
+        for(uint64_t i = start; i < end; i++){ std::sort(first + bounds[i], first + bounds[i +1], comp); }
+    });
+
+    // merge the sorted partitions in rounds, doubling the width of the sorted runs at each round
+    for(uint64_t width = 1; width < num_threads; width *= 2){
+        uint64_t num_merges = (num_threads + 2 * width -1) / (2 * width);
+        parallel_for(num_merges, num_merges, [&](uint64_t start, uint64_t end){
+            for(uint64_t i = start; i < end; i++){
+                uint64_t lo = i * 2 * width;
+                uint64_t mid = std::min(lo + width, num_threads);
+                uint64_t hi = std::min(lo + 2 * width, num_threads);
+                if(mid < hi){ std::inplace_merge(first + bounds[lo], first + bounds[mid], first + bounds[hi], comp); }
+            }
+        });
+    }
+}
+
+// Sort the range [first, last) in ascending order with up to `num_threads' threads
+template<typename RandomIt>
+void parallel_sort(uint64_t num_threads, RandomIt first, RandomIt last){
+    parallel_sort(num_threads, first, last, std::less<>{});
+}
@@ -0,0 +1,175 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "scratch_file.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <unistd.h>
+
+#include "lib/common/error.hpp"
+
+using namespace std;
+
+/*****************************************************************************
+ *                                                                           *
+ *  ScratchFile                                                              *
+ *                                                                           *
+ *****************************************************************************/
+
+template<typename E>
+ScratchFile<E>::ScratchFile(const std::string& directory) {
+    string path_template = directory + "/graphlog.scratch.XXXXXX";
+    unique_ptr<char[]> path { new char[path_template.size() +1] };
+    memcpy(path.get(), path_template.c_str(), path_template.size() +1);
+    m_fd = mkstemp(path.get());
+    if(m_fd < 0) ERROR("Cannot create a temporary file in the scratch directory `" << directory << "': " << strerror(errno));
+    m_path = path.get();
+    unlink(m_path.c_str()); // ignore rc, the space is reclaimed as soon as the file is closed
+}
+
+template<typename E>
+ScratchFile<E>::~ScratchFile(){
+    if(m_fd >= 0){ close(m_fd); m_fd = -1; }
+}
+
+template<typename E>
+void ScratchFile<E>::append(const E* edges, uint64_t count){
+    uint64_t position = m_num_edges;
+    m_num_edges += count;
+    write(position, edges, count);
+}
+
+template<typename E>
+void ScratchFile<E>::resize(uint64_t num_edges){
+    if(ftruncate(m_fd, num_edges * sizeof(E)) != 0) ERROR("Cannot resize the scratch file `" << m_path << "': " << strerror(errno));
+    m_num_edges = num_edges;
+}
+
+template<typename E>
+void ScratchFile<E>::write(uint64_t position, const E* edges, uint64_t count){
+    assert(position + count <= m_num_edges && "Out of bounds");
+    const char* buffer = reinterpret_cast<const char*>(edges);
+    uint64_t buffer_sz = count * sizeof(E);
+    uint64_t offset = position * sizeof(E);
+    while(buffer_sz > 0){
+        ssize_t rc = pwrite(m_fd, buffer, buffer_sz, offset);
+        if(rc < 0 && errno == EINTR) continue;
+        if(rc <= 0) ERROR("Cannot write to the scratch file `" << m_path << "': " << strerror(errno));
+        buffer += rc; buffer_sz -= rc; offset += rc;
+    }
+}
+
+template<typename E>
+void ScratchFile<E>::read(uint64_t position, E* out_edges, uint64_t count) const {
+    assert(position + count <= m_num_edges && "Out of bounds");
+    char* buffer = reinterpret_cast<char*>(out_edges);
+    uint64_t buffer_sz = count * sizeof(E);
+    uint64_t offset = position * sizeof(E);
+    while(buffer_sz > 0){
+        ssize_t rc = pread(m_fd, buffer, buffer_sz, offset);
+        if(rc < 0 && errno == EINTR) continue;
+        if(rc < 0) ERROR("Cannot read from the scratch file `" << m_path << "': " << strerror(errno));
+        if(rc == 0) ERROR("Unexpected end of the scratch file `" << m_path << "'");
+        buffer += rc; buffer_sz -= rc; offset += rc;
+    }
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  ScratchBlockReader                                                       *
+ *                                                                           *
+ *****************************************************************************/
+
+template<typename E>
+ScratchBlockReader<E>::ScratchBlockReader(std::unique_ptr<ScratchFile<E>> file, uint64_t block_capacity) :
+        m_file(move(file)), m_block_capacity(block_capacity),
+        m_num_blocks(m_file->num_edges() / block_capacity + (m_file->num_edges() % block_capacity != 0)){
+    for(uint64_t i = 0; i < 2; i++){
+        m_buffers[i] = (E*) malloc(std::max<uint64_t>(1, std::min(m_block_capacity, m_file->num_edges())) * sizeof(E));
+        if(m_buffers[i] == nullptr){ free(m_buffers[0]); throw bad_alloc(); }
+    }
+    m_background_thread = thread(&ScratchBlockReader<E>::main_read_ahead, this);
+}
+
+template<typename E>
+ScratchBlockReader<E>::~ScratchBlockReader(){
+    { // stop the background thread
+        unique_lock<mutex> lock(m_mutex);
+        m_terminate = true;
+    }
+    m_condvar.notify_all();
+    m_background_thread.join();
+
+    free(m_buffers[0]); m_buffers[0] = nullptr;
+    free(m_buffers[1]); m_buffers[1] = nullptr;
+}
+
+template<typename E>
+uint64_t ScratchBlockReader<E>::get_block_size(uint64_t block_id) const {
+    assert(block_id < m_num_blocks);
+    return (block_id == m_num_blocks -1) ? m_file->num_edges() - block_id * m_block_capacity : m_block_capacity;
+}
+
+template<typename E>
+void ScratchBlockReader<E>::main_read_ahead(){
+    for(uint64_t block_id = 0; block_id < m_num_blocks; block_id++){
+        { // wait for the consumer to release the buffer, which holds the block `block_id - 2'
+            unique_lock<mutex> lock(m_mutex);
+            m_condvar.wait(lock, [&](){ return m_terminate || block_id < 2 || block_id <= m_num_blocks_fetched; });
+            if(m_terminate) return;
+        }
+
+        try {
+            m_file->read(block_id * m_block_capacity, m_buffers[block_id % 2], get_block_size(block_id));
+        } catch (...) {
+            unique_lock<mutex> lock(m_mutex);
+            m_error = current_exception();
+            m_condvar.notify_all();
+            return;
+        }
+
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_num_blocks_read++;
+        }
+        m_condvar.notify_all();
+    }
+}
+
+template<typename E>
+const E* ScratchBlockReader<E>::next(){
+    unique_lock<mutex> lock(m_mutex);
+    if(m_num_blocks_fetched >= m_num_blocks) ERROR("No more blocks to read, total: " << m_num_blocks);
+    uint64_t block_id = m_num_blocks_fetched;
+    m_num_blocks_fetched++; // the buffer of the previous block can be reused
+    m_condvar.notify_all();
+    m_condvar.wait(lock, [&](){ return m_num_blocks_read > block_id || m_error; });
+    if(m_num_blocks_read <= block_id) rethrow_exception(m_error);
+    return m_buffers[block_id % 2];
+}
+
+// explicit instantiations
+template class ScratchFile<Edge>;
+template class ScratchFile<WeightedEdge>;
+template class ScratchBlockReader<Edge>;
+template class ScratchBlockReader<WeightedEdge>;
@@ -0,0 +1,126 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "edge.hpp"
+
+/**
+ * Temporary file of edges in a scratch directory. The file is unlinked as soon as it is created, its space is
+ * released once the instance is destroyed, or when the program terminates. Instantiated for Edge and WeightedEdge.
+ */
+template<typename E>
+class ScratchFile {
+    ScratchFile(const ScratchFile&) = delete;
+    ScratchFile& operator=(const ScratchFile&) = delete;
+
+    int m_fd = -1; // the file descriptor
+    std::string m_path; // the path of the file, only for the error messages
+    uint64_t m_num_edges = 0; // the number of edges stored in the file
+
+public:
+    /**
+     * Create a new temporary file in the given directory
+     */
+    ScratchFile(const std::string& directory);
+
+    // Destructor
+    ~ScratchFile();
+
+    /**
+     * Append the given edges at the end of the file
+     */
+    void append(const E* edges, uint64_t count);
+
+    /**
+     * Set the size of the file, in number of edges
+     */
+    void resize(uint64_t num_edges);
+
+    /**
+     * Overwrite the edges at the given position, in number of edges. The range must be inside the current size of
+     * the file. Concurrent writes are allowed, provided they target disjoint ranges.
+     */
+    void write(uint64_t position, const E* edges, uint64_t count);
+
+    /**
+     * Read `count' edges from the given position, in number of edges. Concurrent reads are allowed.
+     */
+    void read(uint64_t position, E* out_edges, uint64_t count) const;
+
+    /**
+     * The number of edges stored in the file
+     */
+    uint64_t num_edges() const { return m_num_edges; }
+};
+
+/**
+ * Read the blocks of edges stored in a scratch file, one after the other, with a background thread reading ahead the
+ * next block while the current one is being consumed. Instantiated for Edge and WeightedEdge.
+ */
+template<typename E>
+class ScratchBlockReader {
+    ScratchBlockReader(const ScratchBlockReader&) = delete;
+    ScratchBlockReader& operator=(const ScratchBlockReader&) = delete;
+
+    std::unique_ptr<ScratchFile<E>> m_file; // the file with the edges
+    const uint64_t m_block_capacity; // the number of edges in each block, except the last
+    const uint64_t m_num_blocks; // total number of blocks in the file
+    E* m_buffers[2] = { nullptr, nullptr }; // the block being consumed and the block read ahead
+    uint64_t m_num_blocks_read = 0; // number of blocks read so far by the background thread
+    uint64_t m_num_blocks_fetched = 0; // number of blocks fetched so far by the consumer
+    bool m_terminate = false; // whether the background thread should stop
+    std::exception_ptr m_error; // the error raised by the background thread, if any
+    std::mutex m_mutex; // synchronisation with the background thread
+    std::condition_variable m_condvar;
+    std::thread m_background_thread; // handle to the service that reads ahead the blocks
+
+    // Background service, read the blocks in sequence
+    void main_read_ahead();
+
+    // The number of edges in the given block
+    uint64_t get_block_size(uint64_t block_id) const;
+
+public:
+    /**
+     * Create a new instance
+     * @param file the file with the edges, one block after the other
+     * @param block_capacity the number of edges in each block, except the last
+     */
+    ScratchBlockReader(std::unique_ptr<ScratchFile<E>> file, uint64_t block_capacity);
+
+    // Destructor
+    ~ScratchBlockReader();
+
+    /**
+     * Retrieve the next block of edges. The content remains valid until the next invocation.
+     */
+    const E* next();
+
+    /**
+     * Total number of blocks in the file
+     */
+    uint64_t num_blocks() const { return m_num_blocks; }
+};
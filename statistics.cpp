@@ -0,0 +1,199 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "statistics.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "lib/common/error.hpp"
+
+using namespace std;
+
+/*****************************************************************************
+ *                                                                           *
+ *  ResourceUsage                                                            *
+ *                                                                           *
+ *****************************************************************************/
+
+// Current resident set size, from /proc/self/statm. Return 0 if not available.
+static uint64_t get_rss_current(){
+    uint64_t num_pages_total = 0, num_pages_resident = 0;
+    FILE* file = fopen("/proc/self/statm", "r");
+    if(file == nullptr) return 0;
+    int rc = fscanf(file, "%" SCNu64 " %" SCNu64, &num_pages_total, &num_pages_resident);
+    fclose(file);
+    return (rc == 2) ? num_pages_resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) : 0;
+}
+
+ResourceUsage ResourceUsage::now(){
+    ResourceUsage usage;
+    usage.m_wall_time = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+
+    struct rusage ru;
+    if(getrusage(RUSAGE_SELF, &ru) != 0) ERROR("Cannot retrieve the resource usage of the process");
+    usage.m_cpu_time = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000ull + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+    usage.m_rss_peak = static_cast<uint64_t>(ru.ru_maxrss) * 1024; // in KB on Linux
+    usage.m_rss_current = get_rss_current();
+    usage.m_page_faults_minor = ru.ru_minflt;
+    usage.m_page_faults_major = ru.ru_majflt;
+    usage.m_bytes_read = static_cast<uint64_t>(ru.ru_inblock) * 512; // in units of 512 bytes, the same accounting of read_bytes in /proc/self/io
+    usage.m_bytes_written = static_cast<uint64_t>(ru.ru_oublock) * 512;
+
+    return usage;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Registry                                                                 *
+ *                                                                           *
+ *****************************************************************************/
+namespace {
+
+struct PhaseRecord {
+    string m_name;
+    ResourceUsage m_start;
+    ResourceUsage m_end;
+    vector<pair<string, uint64_t>> m_counters;
+};
+
+mutex g_stats_mutex; // protect the properties & the phases
+vector<pair<string, string>> g_stats_properties; // the properties of the run
+vector<PhaseRecord> g_stats_phases; // the phases completed so far
+
+// Write the given string as a JSON literal
+void json_string(ostream& out, const string& value){
+    out << '"';
+    for(char c : value){
+        switch(c){
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if(static_cast<unsigned char>(c) < 0x20){
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+                out << buffer;
+            } else {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+}
+
+} // anonymous namespace
+
+/*****************************************************************************
+ *                                                                           *
+ *  Phase                                                                    *
+ *                                                                           *
+ *****************************************************************************/
+
+Statistics::Phase::Phase(const string& name) : m_name(name), m_start(ResourceUsage::now()) {
+
+}
+
+Statistics::Phase::~Phase(){
+    if(!m_stopped){
+        try {
+            stop();
+        } catch(...) { /* ignore, do not throw from a destructor */ }
+    }
+}
+
+void Statistics::Phase::add_counter(const string& name, uint64_t value){
+    m_counters.emplace_back(name, value);
+}
+
+void Statistics::Phase::stop(){
+    if(m_stopped) return;
+    m_stopped = true;
+
+    PhaseRecord record { m_name, m_start, ResourceUsage::now(), m_counters };
+    scoped_lock<mutex> lock(g_stats_mutex);
+    g_stats_phases.push_back(move(record));
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Statistics                                                               *
+ *                                                                           *
+ *****************************************************************************/
+
+void Statistics::set_property(const string& key, const string& value){
+    scoped_lock<mutex> lock(g_stats_mutex);
+    for(auto& property : g_stats_properties){
+        if(property.first == key){
+            property.second = value;
+            return;
+        }
+    }
+    g_stats_properties.emplace_back(key, value);
+}
+
+void Statistics::save(const string& path){
+    scoped_lock<mutex> lock(g_stats_mutex);
+
+    ofstream out(path, ios::out | ios::trunc);
+    if(!out.good()) ERROR("Cannot open the file `" << path << "' to save the statistics");
+
+    out << "{\n";
+    out << "  \"properties\": {";
+    for(uint64_t i = 0; i < g_stats_properties.size(); i++){
+        out << (i == 0 ? "\n" : ",\n") << "    ";
+        json_string(out, g_stats_properties[i].first);
+        out << ": ";
+        json_string(out, g_stats_properties[i].second);
+    }
+    out << (g_stats_properties.empty() ? "" : "\n  ") << "},\n";
+
+    // rss_peak & rss_current are the values at the end of the phase, the other fields are the deltas in the phase
+    out << "  \"phases\": [";
+    for(uint64_t i = 0; i < g_stats_phases.size(); i++){
+        const PhaseRecord& phase = g_stats_phases[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\n";
+        out << "      \"name\": "; json_string(out, phase.m_name); out << ",\n";
+        out << "      \"wall_time_us\": " << (phase.m_end.m_wall_time - phase.m_start.m_wall_time) << ",\n";
+        out << "      \"cpu_time_us\": " << (phase.m_end.m_cpu_time - phase.m_start.m_cpu_time) << ",\n";
+        out << "      \"rss_peak_bytes\": " << phase.m_end.m_rss_peak << ",\n";
+        out << "      \"rss_current_bytes\": " << phase.m_end.m_rss_current << ",\n";
+        out << "      \"page_faults_minor\": " << (phase.m_end.m_page_faults_minor - phase.m_start.m_page_faults_minor) << ",\n";
+        out << "      \"page_faults_major\": " << (phase.m_end.m_page_faults_major - phase.m_start.m_page_faults_major) << ",\n";
+        out << "      \"bytes_read\": " << (phase.m_end.m_bytes_read - phase.m_start.m_bytes_read) << ",\n";
+        out << "      \"bytes_written\": " << (phase.m_end.m_bytes_written - phase.m_start.m_bytes_written) << ",\n";
+        out << "      \"counters\": {";
+        for(uint64_t j = 0; j < phase.m_counters.size(); j++){
+            out << (j == 0 ? " " : ", ");
+            json_string(out, phase.m_counters[j].first);
+            out << ": " << phase.m_counters[j].second;
+        }
+        out << (phase.m_counters.empty() ? "}" : " }") << "\n";
+        out << "    }";
+    }
+    out << (g_stats_phases.empty() ? "" : "\n  ") << "]\n";
+    out << "}\n";
+
+    out.close();
+    if(out.fail()) ERROR("Cannot write the statistics in the file `" << path << "'");
+}
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Resource usage of the whole process, at a given instant
+ */
+struct ResourceUsage {
+    uint64_t m_wall_time; // monotonic clock, in microseconds
+    uint64_t m_cpu_time; // user + system time of all threads, in microseconds
+    uint64_t m_rss_peak; // max resident set size so far, in bytes
+    uint64_t m_rss_current; // current resident set size, in bytes
+    uint64_t m_page_faults_minor; // page faults served without I/O
+    uint64_t m_page_faults_major; // page faults that required I/O
+    uint64_t m_bytes_read; // bytes read from the storage layer
+    uint64_t m_bytes_written; // bytes written to the storage layer
+
+    // Retrieve the current usage
+    static ResourceUsage now();
+};
+
+/**
+ * Record the resources used by each phase of the program, such as the initialisation steps of the generator, and
+ * save them in a JSON file, with --stats-json. The phases are recorded in a process-wide list, in the order they
+ * complete.
+ */
+class Statistics {
+    Statistics() = delete; // only static methods
+
+public:
+    /**
+     * A phase being measured, from its creation until it is stopped or destroyed
+     */
+    class Phase {
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+
+        const std::string m_name; // the name of the phase in the report
+        const ResourceUsage m_start; // usage at the start of the phase
+        std::vector<std::pair<std::string, uint64_t>> m_counters; // additional counters reported by the phase
+        bool m_stopped = false; // whether the phase has already been recorded
+
+    public:
+        // Start measuring a new phase
+        Phase(const std::string& name);
+
+        // Record the phase, if not already stopped
+        ~Phase();
+
+        // Attach a counter to the phase
+        void add_counter(const std::string& name, uint64_t value);
+
+        // Stop measuring and record the phase
+        void stop();
+    };
+
+    /**
+     * Set a property of the run, such as the input graph or the seed, to save together with the phases
+     */
+    static void set_property(const std::string& key, const std::string& value);
+
+    /**
+     * Save the properties and the phases recorded so far in the given JSON file
+     */
+    static void save(const std::string& path);
+};
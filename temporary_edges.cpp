@@ -0,0 +1,124 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "temporary_edges.hpp"
+
+#include <cassert>
+
+#include "edge_map.hpp"
+
+using namespace std;
+
+/*****************************************************************************
+ *                                                                           *
+ *  TemporaryEdgesABTree                                                     *
+ *                                                                           *
+ *****************************************************************************/
+
+TemporaryEdgesABTree::TemporaryEdgesABTree(EdgeMap& edges_stored, std::mt19937_64& random, uint64_t /* max_size */) : m_edges_stored(edges_stored), m_random(random) {
+
+}
+
+void TemporaryEdgesABTree::insert(Edge edge){
+    uint64_t edge_key = m_unif_keys(m_random);
+    assert(edge_key != 0 && "0 is reserved for the edges of the final graph");
+    m_edges_stored.insert(edge, edge_key);
+    m_tree.insert(edge_key, edge);
+}
+
+void TemporaryEdgesABTree::remove_key(uint64_t key, Edge edge){
+    // The (a,b)-tree may contain multiple edges with the same key (duplicates). In case we removed the
+    // wrong edge, reinsert it with a new key
+    Edge edge_removed;
+    while (m_tree.remove(key, &edge_removed) && edge_removed != edge) {
+        uint64_t new_key = m_unif_keys(m_random);
+        m_tree.insert(new_key, edge_removed);
+        m_edges_stored.insert(edge_removed, new_key);
+        m_num_reinsertions++;
+    };
+    assert(edge_removed == edge && "Cannot find the temporary edge");
+}
+
+void TemporaryEdgesABTree::remove(Edge edge, uint64_t key){
+    remove_key(key, edge);
+}
+
+Edge TemporaryEdgesABTree::remove_random(){
+    assert(!m_tree.empty() && "There are no temporary edges to remove");
+    uint64_t random_key = m_unif_keys(m_random);
+
+    uint64_t edge_key;
+    Edge edge_temporary;
+    { // restrict the scope
+        auto it = m_tree.iterator(random_key, std::numeric_limits<uint64_t>::max());
+        if (it->has_next()) {
+            it->next(&edge_key, &edge_temporary);
+        } else {
+            edge_key = m_tree.key_min();
+            assert(edge_key != 0 && "The value 0 is reserved for final edges");
+            m_tree.find(edge_key, &edge_temporary);
+        }
+    }
+#if !defined(NDEBUG)
+    uint64_t edge_key_stored = 0;
+    assert(m_edges_stored.find(edge_temporary, &edge_key_stored) && "Edge not present in the graph");
+    assert(edge_key_stored == edge_key && "Key mismatch");
+#endif
+
+    remove_key(edge_key, edge_temporary);
+    return edge_temporary;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  TemporaryEdgesVector                                                     *
+ *                                                                           *
+ *****************************************************************************/
+
+TemporaryEdgesVector::TemporaryEdgesVector(EdgeMap& edges_stored, std::mt19937_64& random, uint64_t max_size) : m_edges_stored(edges_stored), m_random(random) {
+    m_edges.reserve(max_size);
+}
+
+void TemporaryEdgesVector::insert(Edge edge){
+    m_edges.push_back(edge);
+    m_edges_stored.insert(edge, /* key */ m_edges.size());
+}
+
+void TemporaryEdgesVector::remove_at(uint64_t position){
+    assert(position < m_edges.size());
+    if(position != m_edges.size() -1){
+        Edge edge_moved = m_edges.back();
+        m_edges[position] = edge_moved;
+        m_edges_stored.insert(edge_moved, /* key */ position +1);
+    }
+    m_edges.pop_back();
+}
+
+void TemporaryEdgesVector::remove(Edge edge, uint64_t key){
+    assert(key > 0 && key <= m_edges.size() && "Invalid key");
+    assert(m_edges[key -1] == edge && "Key mismatch");
+    remove_at(key -1);
+}
+
+Edge TemporaryEdgesVector::remove_random(){
+    assert(!m_edges.empty() && "There are no temporary edges to remove");
+    uniform_int_distribution<uint64_t> unif_position { 0, m_edges.size() -1 };
+    uint64_t position = unif_position(m_random);
+    Edge edge = m_edges[position];
+    remove_at(position);
+    return edge;
+}
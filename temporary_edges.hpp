@@ -0,0 +1,127 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "abtree.hpp"
+#include "edge.hpp"
+
+class EdgeMap; // forward decl.
+
+/**
+ * The stores of the temporary edges, the edges inserted during the generation that need to be removed before its
+ * end. Each temporary edge is associated to a key in the map of the edges stored in the graph, which the store
+ * maintains. The key 0 is reserved for the final edges. Both stores expose the same interface to the generator:
+ * - insert(edge): add the edge and set its key in the map
+ * - remove(edge, key): remove the given edge, with its current key. Its entry in the map is left to the caller
+ * - remove_random(): remove an edge chosen uniformly at random. Its entry in the map is left to the caller
+ */
+
+/**
+ * Temporary edges indexed by a random key in an (a,b)-tree. An edge is removed at random by drawing a key and
+ * visiting the next one in the tree. As distinct edges can be drawn the same key, removals may need to reinsert the
+ * edges removed by mistake with a new key. This is the store of the versions preceding TemporaryEdgesVector and it
+ * consumes the random generator in the same way: with the CountingTreeSampler, the same seed and the same options, it
+ * reproduces the logs of the versions that already shuffled the final edges on load (EdgeShuffle) and broke the ties
+ * by offset when sorting the vertices by frequency. The logs of the older versions, which permuted the final edges at
+ * startup, are not reproduced, as the order of the final edges differs.
+ */
+class TemporaryEdgesABTree {
+    TemporaryEdgesABTree(const TemporaryEdgesABTree&) = delete;
+    TemporaryEdgesABTree& operator=(const TemporaryEdgesABTree&) = delete;
+
+    ABTree<uint64_t, Edge> m_tree; // the actual content, random key -> edge
+    EdgeMap& m_edges_stored; // the edges stored in the graph, with their key
+    std::mt19937_64& m_random; // random generator, shared with the generator
+    std::uniform_int_distribution<uint64_t> m_unif_keys { 1, std::numeric_limits<uint64_t>::max() }; // to draw the keys
+    uint64_t m_num_reinsertions = 0; // number of edges reinserted with a new key, due to duplicate keys
+
+    // Remove the edge with the given key, reinserting with a new key the other edges with the same key removed by mistake
+    void remove_key(uint64_t key, Edge edge);
+
+public:
+    // Create an empty store. The tree grows on demand, `max_size' is ignored
+    TemporaryEdgesABTree(EdgeMap& edges_stored, std::mt19937_64& random, uint64_t max_size);
+
+    // Add a new temporary edge
+    void insert(Edge edge);
+
+    // Remove the given edge, with its current key
+    void remove(Edge edge, uint64_t key);
+
+    // Remove an edge chosen uniformly at random, and return it
+    Edge remove_random();
+
+    // Number of temporary edges
+    uint64_t size() const { return m_tree.size(); }
+
+    // Whether there are no temporary edges
+    bool empty() const { return m_tree.empty(); }
+
+    // Memory footprint of the store, in bytes
+    uint64_t memory_footprint() const { return m_tree.memory_footprint(); }
+
+    // Number of edges reinserted with a new key, due to duplicate keys
+    uint64_t num_reinsertions() const { return m_num_reinsertions; }
+};
+
+/**
+ * Temporary edges stored in a dense array. The key of each edge is its position in the array + 1. An edge is removed
+ * by moving the last edge of the array in its place, so that both removals at random and removals of a given edge take
+ * constant time.
+ */
+class TemporaryEdgesVector {
+    TemporaryEdgesVector(const TemporaryEdgesVector&) = delete;
+    TemporaryEdgesVector& operator=(const TemporaryEdgesVector&) = delete;
+
+    std::vector<Edge> m_edges; // the actual content
+    EdgeMap& m_edges_stored; // the edges stored in the graph, with their key
+    std::mt19937_64& m_random; // random generator, shared with the generator
+
+    // Remove the edge at the given position
+    void remove_at(uint64_t position);
+
+public:
+    // Create an empty store, able to hold up to `max_size' edges without reallocating
+    TemporaryEdgesVector(EdgeMap& edges_stored, std::mt19937_64& random, uint64_t max_size);
+
+    // Add a new temporary edge
+    void insert(Edge edge);
+
+    // Remove the given edge, with its current key
+    void remove(Edge edge, uint64_t key);
+
+    // Remove an edge chosen uniformly at random, and return it
+    Edge remove_random();
+
+    // Number of temporary edges
+    uint64_t size() const { return m_edges.size(); }
+
+    // Whether there are no temporary edges
+    bool empty() const { return m_edges.empty(); }
+
+    // Memory footprint of the store, in bytes
+    uint64_t memory_footprint() const { return m_edges.capacity() * sizeof(Edge); }
+
+    // Always 0, the keys are unique
+    uint64_t num_reinsertions() const { return 0; }
+};
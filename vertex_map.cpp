@@ -0,0 +1,120 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "vertex_map.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+#include "lib/common/error.hpp"
+#include "hash.hpp"
+
+VertexMap::VertexMap(uint64_t max_size) : m_max_size(max_size) {
+    uint64_t capacity = 16;
+    while(capacity < 2 * max_size){ capacity *= 2; }
+    m_capacity_mask = capacity -1;
+
+    int rc = posix_memalign((void**) &m_slots, /* alignment */ 64,  /* size */ capacity * sizeof(Slot));
+    if(rc != 0) { throw std::bad_alloc(); }
+    for(uint64_t i = 0; i < capacity; i++){ m_slots[i].m_key = EMPTY; }
+}
+
+VertexMap::~VertexMap(){
+    free(m_slots); m_slots = nullptr;
+}
+
+VertexMap::Slot* VertexMap::probe(uint64_t key) const {
+    assert(key != EMPTY);
+    uint64_t position = mix64(key) & m_capacity_mask; // spread consecutive keys across the whole table
+    while(m_slots[position].m_key != key && m_slots[position].m_key != EMPTY){
+        position = (position +1) & m_capacity_mask;
+    }
+    return m_slots + position;
+}
+
+void VertexMap::insert(uint64_t key, uint64_t value){
+    if(key == EMPTY){
+        m_has_empty_key = true;
+        m_empty_key_value = value;
+        return;
+    }
+
+    Slot* slot = probe(key);
+    if(slot->m_key == EMPTY){
+        if(m_size >= m_max_size) ERROR("The map is full, max size: " << m_max_size);
+        slot->m_key = key;
+        m_size++;
+    }
+    slot->m_value = value;
+}
+
+bool VertexMap::find(uint64_t key, uint64_t* out_value) const {
+    if(key == EMPTY){
+        if(m_has_empty_key){ *out_value = m_empty_key_value; }
+        return m_has_empty_key;
+    }
+
+    Slot* slot = probe(key);
+    if(slot->m_key == EMPTY) return false;
+    *out_value = slot->m_value;
+    return true;
+}
+
+uint64_t VertexMap::find(const uint64_t* keys, uint64_t* out_values, uint64_t count) const {
+    constexpr uint64_t group_sz = 16; // number of slots prefetched ahead
+    uint64_t positions[group_sz];
+
+    for(uint64_t group_start = 0; group_start < count; group_start += group_sz){
+        uint64_t group_end = std::min(count, group_start + group_sz);
+
+        // first pass, prefetch the home slot of each key in the group
+        for(uint64_t i = group_start; i < group_end; i++){
+            uint64_t position = mix64(keys[i]) & m_capacity_mask;
+            positions[i - group_start] = position;
+            __builtin_prefetch(m_slots + position, /* read */ 0, /* high temporal locality */ 3);
+        }
+
+        // second pass, probe the slots
+        for(uint64_t i = group_start; i < group_end; i++){
+            uint64_t key = keys[i];
+            if(key == EMPTY){
+                if(!m_has_empty_key) return i;
+                out_values[i] = m_empty_key_value;
+                continue;
+            }
+
+            uint64_t position = positions[i - group_start];
+            while(m_slots[position].m_key != key && m_slots[position].m_key != EMPTY){
+                position = (position +1) & m_capacity_mask;
+            }
+            if(m_slots[position].m_key == EMPTY) return i; // not found
+            out_values[i] = m_slots[position].m_value;
+        }
+    }
+
+    return count;
+}
+
+uint64_t VertexMap::size() const {
+    return m_size + m_has_empty_key;
+}
+
+uint64_t VertexMap::footprint() const {
+    return (m_capacity_mask +1) * sizeof(Slot);
+}
@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+
+/**
+ * Hash map from uint64_t keys to uint64_t values, to translate the external vertex IDs into dense IDs. The entries
+ * are stored inline in a single array with linear probing, sized once at construction time to keep the load factor
+ * at most 1/2. Entries can only be inserted, not removed.
+ *
+ * The class is not thread safe
+ */
+class VertexMap {
+    VertexMap(const VertexMap&) = delete;
+    VertexMap& operator=(const VertexMap&) = delete;
+
+    struct Slot {
+        uint64_t m_key;
+        uint64_t m_value;
+    };
+
+    constexpr static uint64_t EMPTY = static_cast<uint64_t>(-1); // marker for the empty slots
+    Slot* m_slots = nullptr; // the actual content of the map
+    uint64_t m_capacity_mask = 0; // number of slots - 1, the number of slots is a power of 2
+    uint64_t m_size = 0; // number of entries stored, excluding the key EMPTY
+    const uint64_t m_max_size; // max number of entries that can be stored
+    bool m_has_empty_key = false; // whether the key EMPTY, which cannot be stored in a slot, has been inserted
+    uint64_t m_empty_key_value = 0; // the value associated to the key EMPTY
+
+    // Retrieve the slot for the given key, either the slot storing the key or the empty slot where it would be stored
+    Slot* probe(uint64_t key) const;
+
+public:
+    // Create a map that can store up to `max_size' entries
+    VertexMap(uint64_t max_size);
+
+    // Destructor
+    ~VertexMap();
+
+    // Insert or replace the value associated to the given key
+    void insert(uint64_t key, uint64_t value);
+
+    // Retrieve the value associated to the given key. Return false if the key is not present
+    bool find(uint64_t key, uint64_t* out_value) const;
+
+    // Retrieve the values associated to a batch of keys. The slots of the keys are prefetched ahead of the
+    // lookups, to overlap the cache misses. The arrays `keys' and `out_values' can overlap. Return the number of
+    // leading keys found: when less than `count', the key at that index is not present and its value is not set.
+    uint64_t find(const uint64_t* keys, uint64_t* out_values, uint64_t count) const;
+
+    // Number of entries stored
+    uint64_t size() const;
+
+    // Memory footprint of the map, in bytes
+    uint64_t footprint() const;
+};
@@ -0,0 +1,81 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: hello[at]whatsthecraic.net
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <random>
+
+#include "alias_table.hpp"
+#include "counting_tree.hpp"
+#include "degree_buckets.hpp"
+
+/**
+ * The samplers of the endpoints of the temporary edges, each vertex is drawn in proportion to its frequency. All
+ * samplers expose the same interface to the generator:
+ * - sample(random): draw a vertex
+ * - sample_excluding(vertex, random): draw a vertex other than the given one, in proportion to the frequencies of
+ *   the remaining vertices
+ */
+
+/**
+ * Draw the vertices through the CountingTree, in O(log n). The excluded vertex is skipped while descending the tree,
+ * without altering it, with the same outcome of unsetting it for the duration of the draw, as in the previous
+ * versions. Together with the TemporaryEdgesABTree, it reproduces the logs of the versions that already shuffled the
+ * final edges on load, but not of those that permuted them at startup (see TemporaryEdgesABTree).
+ */
+class CountingTreeSampler {
+    const CountingTree& m_tree;
+
+public:
+    CountingTreeSampler(const CountingTree& tree) : m_tree(tree) { }
+
+    uint32_t sample(std::mt19937_64& random) {
+        std::uniform_int_distribution<uint64_t> unif{0, (uint64_t) m_tree.total_count() - 1};
+        return m_tree.search(unif(random));
+    }
+
+    uint32_t sample_excluding(uint32_t vertex, std::mt19937_64& random) {
+        std::uniform_int_distribution<uint64_t> unif{0, (uint64_t) (m_tree.total_count() - m_tree.get(vertex)) - 1};
+        return m_tree.search_excluding(unif(random), vertex);
+    }
+};
+
+/**
+ * Draw the vertices through a static table, either an AliasTable or DegreeBuckets, in O(1). The excluded vertex is
+ * rejected and drawn again.
+ */
+template<typename Table>
+class StaticTableSampler {
+    const Table& m_table;
+
+public:
+    StaticTableSampler(const Table& table) : m_table(table) { }
+
+    uint32_t sample(std::mt19937_64& random) {
+        return m_table.sample(random);
+    }
+
+    uint32_t sample_excluding(uint32_t vertex, std::mt19937_64& random) {
+        uint32_t result;
+        do { result = m_table.sample(random); } while (result == vertex);
+        return result;
+    }
+};
+
+using AliasTableSampler = StaticTableSampler<AliasTable>;
+using DegreeBucketSampler = StaticTableSampler<DegreeBuckets>;
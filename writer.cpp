@@ -58,7 +58,8 @@ extern std::mutex g_mutex_log;
  *                                                                           *
  *****************************************************************************/
 
-Writer::Writer() : m_num_compression_threads(std::max<int64_t>(1, static_cast<int64_t>(cpu_topology().get_threads(false, false).size()) -2)){
+Writer::Writer() : m_num_compression_threads(std::max<int64_t>(1, static_cast<int64_t>(cpu_topology().get_threads(false, false).size()) -2)),
+        m_max_pending_compressions(default_max_pending_compressions()){
     m_properties.emplace_back("internal.vertices.final.begin", "                   ");
     m_properties.emplace_back("internal.vertices.temporary.begin", "                   ");
     m_properties.emplace_back("internal.edges.begin", "                   ");
@@ -223,6 +224,13 @@ void Writer::open_stream_edges(){
     m_async_condvar.wait(lock, [this](){ return m_async_queue_w.empty(); });
 }
 
+void Writer::set_max_pending_compressions(uint64_t value){
+    if(value == 0) INVALID_ARGUMENT("The number of pending compressions must be greater than 0");
+    scoped_lock<mutex> lock(m_async_mutex);
+    if(m_async_writer.joinable()) ERROR("Cannot alter the queue of the stream, it has already been initialised");
+    m_max_pending_compressions = value;
+}
+
 void Writer::write_edges(uint8_t* buffer, uint64_t buffer_sz){
     if(buffer == nullptr) return; /* nop */
 
@@ -46,6 +46,7 @@ class Writer {
 
     // asynchronously compress & write block of edges to the log file
     const uint64_t m_num_compression_threads; // number of threads to use for compression
+    uint64_t m_max_pending_compressions; // max number of edge buffers that can be queued pending compression
     uint64_t m_task_id = std::numeric_limits<uint64_t>::max(); // ID of the current task sent to the queue
     std::mutex m_async_mutex; // synchronisation with the background services
     std::condition_variable m_async_condvar;
@@ -73,9 +74,6 @@ class Writer {
     // Set the current position in the output stream for the given placeholder
     void set_marker(std::streampos placeholder);
 
-    // Maximum number of edge buffers that can be queued pending compression
-    static constexpr uint64_t max_pending_compressions();
-
 public:
     // Create a new instance, without creating the file yet
     Writer();
@@ -100,6 +98,18 @@ public:
     // The size of each block of edges, in bytes
     constexpr static uint64_t edges_block_size();
 
+    // The default for the maximum number of edge buffers that can be queued pending compression
+    constexpr static uint64_t default_max_pending_compressions();
+
+    // Maximum number of edge buffers that can be queued pending compression
+    uint64_t max_pending_compressions() const { return m_max_pending_compressions; }
+
+    // Set the maximum number of edge buffers that can be queued pending compression, before the stream is opened
+    void set_max_pending_compressions(uint64_t value);
+
+    // Number of threads compressing the blocks of edges in the background
+    uint64_t num_compression_threads() const { return m_num_compression_threads; }
+
     // Init the stream of edges
     void open_stream_edges();
 
@@ -131,6 +141,6 @@ constexpr uint64_t Writer::edges_block_size(){
     return num_edges_per_block() * (/* src */ sizeof(uint64_t) + /* dst */ sizeof(uint64_t) + /* weight */ sizeof(double));
 }
 
-constexpr uint64_t Writer::max_pending_compressions(){
+constexpr uint64_t Writer::default_max_pending_compressions(){
     return 8ull;
 }